@@ -0,0 +1,92 @@
+/**
+ * Microbenchmarks of the search indexes in searchindex.hpp against
+ * std::lower_bound, over a sorted array of random int32_t keys.
+ * Output is one JSON object per line, e.g.,
+ *     {"bench":"eytzinger","keys":33554432,"queries":4194304,"ns_per_op":...}
+ * Usage: wttool_bench_search [keys=33554432] [queries=4194304]
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "searchindex.hpp"
+#include "stloperation.hpp"
+
+using namespace wttool;
+
+static void report(const char* bench, int64_t keys, int64_t queries,
+                   std::chrono::steady_clock::time_point begin, int64_t sum) {
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count();
+    printf("{\"bench\":\"%s\",\"keys\":%ld,\"queries\":%ld,\"ns_per_op\":%.2f,\"checksum\":%ld}\n",
+           bench, (long)keys, (long)queries, ns / queries, (long)sum);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    std::map<string, string> args = parse_arg(argc, argv);
+    int64_t keys = args.count("keys") ? str2num(args["keys"]) : ((int64_t)1 << 25);
+    int64_t queries = args.count("queries") ? str2num(args["queries"]) : ((int64_t)1 << 22);
+
+    std::mt19937 gen(35);
+    vector<int32_t> data(keys);
+    for (int64_t i = 0; i < keys; ++i) {
+        data[i] = (int32_t)gen();
+    }
+    std::sort(data.begin(), data.end());
+    vector<int32_t> query(queries);
+    for (int64_t i = 0; i < queries; ++i) {
+        query[i] = (int32_t)gen();
+    }
+    vector<int64_t> res(queries);
+
+    auto begin = std::chrono::steady_clock::now();
+    int64_t sum = 0;
+    for (int64_t i = 0; i < queries; ++i) {
+        sum += std::lower_bound(data.begin(), data.end(), query[i]) - data.begin();
+    }
+    report("std_lower_bound", keys, queries, begin, sum);
+
+    EytzingerIndex<int32_t> eytzinger;
+    eytzinger.build(data.data(), keys);
+    begin = std::chrono::steady_clock::now();
+    sum = 0;
+    for (int64_t i = 0; i < queries; ++i) {
+        sum += eytzinger.lower_bound(query[i]);
+    }
+    report("eytzinger", keys, queries, begin, sum);
+
+    begin = std::chrono::steady_clock::now();
+    eytzinger.lower_bound_batch(query.data(), queries, res.data());
+    sum = 0;
+    for (int64_t i = 0; i < queries; ++i) {
+        sum += res[i];
+    }
+    report("eytzinger_batch", keys, queries, begin, sum);
+
+    BTreeIndex<int32_t> btree;
+    btree.build(data.data(), keys);
+    begin = std::chrono::steady_clock::now();
+    sum = 0;
+    for (int64_t i = 0; i < queries; ++i) {
+        sum += btree.lower_bound(query[i]);
+    }
+    report("btree", keys, queries, begin, sum);
+
+    begin = std::chrono::steady_clock::now();
+    btree.lower_bound_batch(query.data(), queries, res.data());
+    sum = 0;
+    for (int64_t i = 0; i < queries; ++i) {
+        sum += res[i];
+    }
+    report("btree_batch", keys, queries, begin, sum);
+    return 0;
+}
@@ -0,0 +1,431 @@
+/**
+ * Microbenchmarks of the string and parsing tools in stloperation.hpp and
+ * wtmemcpy in systool.hpp.
+ * Every case runs over generated corpora, short and long lines, few and many
+ * delimiters, ASCII and UTF-8, by 1 thread and by several threads.
+ * Output is one JSON object per line, e.g.,
+ *     {"bench":"splitstr","corpus":"short_ascii_few","threads":1,"ops":...,
+ *      "ns_per_op":...,"bytes_per_sec":...,"allocs_per_op":...}
+ * ns_per_op is the time of one thread per op, bytes_per_sec is the total of
+ * all threads, allocs_per_op counts calls of operator new.
+ * Usage: wttool_bench_strings [min_ms=200] [threads=N] [filter=name]
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "stloperation.hpp"
+#include "systool.hpp"
+
+using namespace wttool;
+
+// Allocations of the current thread.
+static thread_local uint64_t g_allocs = 0;
+
+void* operator new(size_t size) {
+    ++g_allocs;
+    void* res = malloc(size == 0 ? 1 : size);
+    if (res == nullptr) {
+        throw std::bad_alloc();
+    }
+    return res;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+// Keeps the results alive.
+static std::atomic<uint64_t> g_sink(0);
+
+/**
+ * One pass over the corpus.
+ * @param bytes: Add the input bytes handled.
+ * @return The number of ops.
+ */
+typedef std::function<uint64_t(uint64_t* bytes)> BenchPass;
+
+struct BenchCase {
+    string    bench;
+    string    corpus;
+    BenchPass pass;
+};
+
+struct Corpus {
+    string         name;
+    vector<string> lines;
+    string         token;
+};
+
+/**
+ * Words of 1 to max_word characters separated by the token, about length bytes.
+ */
+static string make_line(std::mt19937& gen, size_t length, size_t max_word, const string& token, bool utf8) {
+    static const char* utf8_chars[] = {"\xc3\xa9", "\xc3\xbc", "\xe4\xb8\xad", "\xe6\x96\x87",
+                                       "\xd0\x96", "\xf0\x9f\x98\x80"};
+    string res;
+    while (res.size() < length) {
+        if (!res.empty()) {
+            res += token;
+        }
+        size_t word = 1 + gen() % max_word;
+        for (size_t i = 0; i < word; ++i) {
+            if (utf8 && gen() % 2 == 0) {
+                res += utf8_chars[gen() % 6];
+            } else {
+                res += (char)('a' + gen() % 26);
+            }
+        }
+    }
+    return res;
+}
+
+/**
+ * About total bytes of lines.
+ */
+static Corpus make_corpus(const string& name, size_t line_length, size_t max_word,
+                          bool utf8, size_t total) {
+    std::mt19937 gen(line_length * 31 + max_word);
+    Corpus res;
+    res.name = name;
+    res.token = "\t";
+    size_t bytes = 0;
+    while (bytes < total) {
+        res.lines.push_back(make_line(gen, line_length, max_word, res.token, utf8));
+        bytes += res.lines.back().size();
+    }
+    return res;
+}
+
+static vector<Corpus> make_corpora() {
+    vector<Corpus> res;
+    const size_t total = 1 << 20;
+    res.push_back(make_corpus("short_ascii_few", 48, 16, false, total));
+    res.push_back(make_corpus("short_ascii_many", 48, 2, false, total));
+    res.push_back(make_corpus("long_ascii_few", 4096, 256, false, total));
+    res.push_back(make_corpus("long_ascii_many", 4096, 2, false, total));
+    res.push_back(make_corpus("short_utf8_few", 48, 8, true, total));
+    res.push_back(make_corpus("long_utf8_many", 4096, 2, true, total));
+    return res;
+}
+
+static uint64_t lines_bytes(const vector<string>& lines) {
+    uint64_t res = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        res += lines[i].size();
+    }
+    return res;
+}
+
+static void add_cases(vector<BenchCase>* cases, const vector<Corpus>& corpora) {
+    for (size_t c = 0; c < corpora.size(); ++c) {
+        const Corpus* corpus = &corpora[c];
+        uint64_t size = lines_bytes(corpus->lines);
+
+        cases->push_back(BenchCase{"splitstr", corpus->name, [corpus, size](uint64_t* bytes) {
+            uint64_t fields = 0;
+            for (size_t i = 0; i < corpus->lines.size(); ++i) {
+                fields += splitstr(corpus->lines[i], corpus->token).size();
+            }
+            g_sink += fields;
+            *bytes += size;
+            return (uint64_t)corpus->lines.size();
+        }});
+
+        cases->push_back(BenchCase{"splitstr_view", corpus->name, [corpus, size](uint64_t* bytes) {
+            static thread_local vector<StrView> fields;
+            uint64_t count = 0;
+            for (size_t i = 0; i < corpus->lines.size(); ++i) {
+                const string& line = corpus->lines[i];
+                count += splitstr(line.data(), line.size(), corpus->token, &fields);
+            }
+            g_sink += count;
+            *bytes += size;
+            return (uint64_t)corpus->lines.size();
+        }});
+
+        cases->push_back(BenchCase{"trimstr", corpus->name, [corpus, size](uint64_t* bytes) {
+            uint64_t count = 0;
+            for (size_t i = 0; i < corpus->lines.size(); ++i) {
+                count += trimstr(corpus->lines[i]).size();
+            }
+            g_sink += count;
+            *bytes += size;
+            return (uint64_t)corpus->lines.size();
+        }});
+    }
+}
+
+/**
+ * Decimal strings of short and long numbers.
+ */
+static void add_number_cases(vector<BenchCase>* cases) {
+    static vector<int64_t> values[2];
+    static vector<string> numbers[2];
+    static const char* names[2] = {"short_numbers", "long_numbers"};
+    std::mt19937_64 gen(7);
+    for (int i = 0; i < 10000; ++i) {
+        values[0].push_back((int64_t)(gen() % 10000) - 5000);
+        values[1].push_back((int64_t)gen());
+    }
+    for (int n = 0; n < 2; ++n) {
+        for (size_t i = 0; i < values[n].size(); ++i) {
+            numbers[n].push_back(num2str(values[n][i]));
+        }
+        const vector<int64_t>* nums = &values[n];
+        const vector<string>* corpus = &numbers[n];
+        uint64_t size = lines_bytes(*corpus);
+        cases->push_back(BenchCase{"str2num", names[n], [corpus, size](uint64_t* bytes) {
+            int64_t sum = 0;
+            for (size_t i = 0; i < corpus->size(); ++i) {
+                sum += str2num((*corpus)[i]);
+            }
+            g_sink += sum;
+            *bytes += size;
+            return (uint64_t)corpus->size();
+        }});
+        cases->push_back(BenchCase{"str2num_view", names[n], [corpus, size](uint64_t* bytes) {
+            int64_t sum = 0;
+            for (size_t i = 0; i < corpus->size(); ++i) {
+                sum += str2num(StrView((*corpus)[i]));
+            }
+            g_sink += sum;
+            *bytes += size;
+            return (uint64_t)corpus->size();
+        }});
+        cases->push_back(BenchCase{"num2str", names[n], [nums](uint64_t* bytes) {
+            uint64_t count = 0;
+            for (size_t i = 0; i < nums->size(); ++i) {
+                count += num2str((*nums)[i]).size();
+            }
+            g_sink += count;
+            *bytes += count;
+            return (uint64_t)nums->size();
+        }});
+    }
+    cases->push_back(BenchCase{"cur_time", "none", [](uint64_t* bytes) {
+        uint64_t count = 0;
+        for (int i = 0; i < 1000; ++i) {
+            count += cur_time().size();
+        }
+        g_sink += count;
+        *bytes += count;
+        return (uint64_t)1000;
+    }});
+}
+
+static void add_map_cases(vector<BenchCase>* cases) {
+    static std::map<string, string> maps[2];
+    static std::unordered_map<string, string> hash_maps[2];
+    static const char* names[2] = {"map_8", "map_64"};
+    static const int sizes[2] = {8, 64};
+    for (int n = 0; n < 2; ++n) {
+        for (int i = 0; i < sizes[n]; ++i) {
+            maps[n]["key_" + num2str(i)] = "value_" + num2str(i * 7919);
+            hash_maps[n]["key_" + num2str(i)] = "value_" + num2str(i * 7919);
+        }
+        const std::map<string, string>* in = &maps[n];
+        const std::unordered_map<string, string>* hash_in = &hash_maps[n];
+        cases->push_back(BenchCase{"print_map", names[n], [in](uint64_t* bytes) {
+            uint64_t count = 0;
+            for (int i = 0; i < 100; ++i) {
+                count += print_map(*in).size();
+            }
+            g_sink += count;
+            *bytes += count;
+            return (uint64_t)100;
+        }});
+        cases->push_back(BenchCase{"print_unordered_map", names[n], [hash_in](uint64_t* bytes) {
+            uint64_t count = 0;
+            for (int i = 0; i < 100; ++i) {
+                count += print_map(*hash_in).size();
+            }
+            g_sink += count;
+            *bytes += count;
+            return (uint64_t)100;
+        }});
+    }
+
+    // argv of --key=value, some with blanks to be trimmed.
+    static vector<string> args[2];
+    static vector<char*> argv[2];
+    static const char* arg_names[2] = {"argv_8", "argv_64"};
+    for (int n = 0; n < 2; ++n) {
+        args[n].push_back("wttool_bench_strings");
+        for (int i = 0; i < sizes[n]; ++i) {
+            args[n].push_back("--option_" + num2str(i) + "=" + ((i % 3 == 0) ? " " : "") + "val_" + num2str(i));
+        }
+        for (size_t i = 0; i < args[n].size(); ++i) {
+            argv[n].push_back(&args[n][i][0]);
+        }
+        vector<char*>* in = &argv[n];
+        uint64_t size = lines_bytes(args[n]);
+        cases->push_back(BenchCase{"parse_arg", arg_names[n], [in, size](uint64_t* bytes) {
+            uint64_t count = 0;
+            for (int i = 0; i < 100; ++i) {
+                count += parse_arg(in->size(), in->data()).size();
+            }
+            g_sink += count;
+            *bytes += size * 100;
+            return (uint64_t)100;
+        }});
+    }
+}
+
+/**
+ * wtmemcpy goes through one static buffer shared by all threads, so the
+ * threaded runs show the contention on it. The copied data of those runs may
+ * be mixed up, only the time is measured. memcpy is the baseline.
+ */
+static void add_memcpy_cases(vector<BenchCase>* cases) {
+    static const size_t sizes[3] = {64, 4096, 1 << 20};
+    static const char* names[3] = {"64B", "4KB", "1MB"};
+    for (int n = 0; n < 3; ++n) {
+        size_t size = sizes[n];
+        uint64_t repeat = (size >= 4096) ? 64 : 4096;
+        cases->push_back(BenchCase{"wtmemcpy", names[n], [size, repeat](uint64_t* bytes) {
+            static thread_local vector<char> src;
+            static thread_local vector<char> des;
+            src.resize(size, 'x');
+            des.resize(size);
+            for (uint64_t i = 0; i < repeat; ++i) {
+                wtmemcpy(des.data(), src.data(), size);
+            }
+            g_sink += des[size - 1];
+            *bytes += size * repeat;
+            return repeat;
+        }});
+        cases->push_back(BenchCase{"memcpy", names[n], [size, repeat](uint64_t* bytes) {
+            static thread_local vector<char> src;
+            static thread_local vector<char> des;
+            src.resize(size, 'x');
+            des.resize(size);
+            for (uint64_t i = 0; i < repeat; ++i) {
+                memcpy(des.data(), src.data(), size);
+                // Keep the copies from being merged.
+                __asm__ __volatile__("" : : "r"(des.data()) : "memory");
+            }
+            g_sink += des[size - 1];
+            *bytes += size * repeat;
+            return repeat;
+        }});
+    }
+}
+
+/**
+ * Run passes on every thread until min_ms passed, then print one JSON line.
+ */
+static void run_case(const BenchCase& bench, int threads, int64_t min_ms) {
+    vector<uint64_t> ops(threads, 0);
+    vector<uint64_t> bytes(threads, 0);
+    vector<uint64_t> allocs(threads, 0);
+    vector<std::thread> workers;
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    std::chrono::steady_clock::time_point begin;
+    auto body = [&](int t) {
+        // Warm up, e.g., the thread local buffers, each thread has its own.
+        uint64_t warm_bytes = 0;
+        bench.pass(&warm_bytes);
+        ++ready;
+        if (t == 0) {
+            while (ready.load() < threads) {
+                std::this_thread::yield();
+            }
+            begin = std::chrono::steady_clock::now();
+            go = true;
+        }
+        while (!go.load()) {
+            std::this_thread::yield();
+        }
+        uint64_t allocs_begin = g_allocs;
+        auto pass_begin = std::chrono::steady_clock::now();
+        do {
+            ops[t] += bench.pass(&bytes[t]);
+        } while (std::chrono::steady_clock::now() - pass_begin < std::chrono::milliseconds(min_ms));
+        allocs[t] = g_allocs - allocs_begin;
+    };
+    for (int t = 1; t < threads; ++t) {
+        workers.push_back(std::thread(body, t));
+    }
+    body(0);
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count();
+
+    uint64_t total_ops = 0;
+    uint64_t total_bytes = 0;
+    uint64_t total_allocs = 0;
+    for (int t = 0; t < threads; ++t) {
+        total_ops += ops[t];
+        total_bytes += bytes[t];
+        total_allocs += allocs[t];
+    }
+    printf("{\"bench\":\"%s\",\"corpus\":\"%s\",\"threads\":%d,\"ops\":%lu,"
+           "\"ns_per_op\":%.2f,\"bytes_per_sec\":%.0f,\"allocs_per_op\":%.3f}\n",
+           bench.bench.c_str(), bench.corpus.c_str(), threads, (unsigned long)total_ops,
+           ns * threads / total_ops, total_bytes / (ns / 1e9), (double)total_allocs / total_ops);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    std::map<string, string> args = parse_arg(argc, argv);
+    int64_t min_ms = args.count("min_ms") ? str2num(args["min_ms"]) : 200;
+    int threads = std::thread::hardware_concurrency();
+    threads = (threads > 8) ? 8 : ((threads < 2) ? 2 : threads);
+    if (args.count("threads")) {
+        threads = str2num(args["threads"]);
+        threads = (threads < 1) ? 1 : threads;
+    }
+    string filter = args.count("filter") ? args["filter"] : "";
+
+    vector<Corpus> corpora = make_corpora();
+    vector<BenchCase> cases;
+    add_cases(&cases, corpora);
+    add_number_cases(&cases);
+    add_map_cases(&cases);
+    add_memcpy_cases(&cases);
+
+    for (size_t i = 0; i < cases.size(); ++i) {
+        if (!filter.empty() && cases[i].bench.find(filter) == string::npos) {
+            continue;
+        }
+        run_case(cases[i], 1, min_ms);
+        if (threads > 1) {
+            run_case(cases[i], threads, min_ms);
+        }
+    }
+    return g_sink.load() == 0xffffffffffffffffULL;
+}
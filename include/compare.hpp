@@ -11,6 +11,9 @@
 #define __WTTOOL_COMPARE_H_
 
 #include <iostream>
+#include <string>
+#include <stdint.h>
+#include <string.h>
 
 namespace wttool {
 
@@ -148,26 +151,106 @@ int cmp(const unsigned char& lhs, const unsigned char& rhs) {
     return 1;
 }    
 
+/**
+ * Comparison function for double, NaN is not ordered.
+ */
+template <>
+int cmp(const double& lhs, const double& rhs) {
+    if (lhs < rhs) {
+        return -1;
+    } else if (lhs == rhs) {
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Comparison function for float, NaN is not ordered.
+ */
+template <>
+int cmp(const float& lhs, const float& rhs) {
+    if (lhs < rhs) {
+        return -1;
+    } else if (lhs == rhs) {
+        return 0;
+    }
+    return 1;
+}
+
 /**
  * Comparison function for string.
+ * Bytes are compared as unsigned char, so bytes >= 0x80 sort after ASCII.
  */
 template <>
 int cmp(const string& lhs, const string& rhs) {
     size_t length = (lhs.size() > rhs.size()) ? rhs.size() : lhs.size();
-    for (size_t i = 0; i < length; ++i) {
-        if (lhs[i] == rhs[i]) {
-            continue;
-        }
-        return lhs[i] - rhs[i];
+    int res = memcmp(lhs.data(), rhs.data(), length);
+    if (res != 0) {
+        return (res < 0) ? -1 : 1;
     }
     if (lhs.size() == rhs.size()) {
         return 0;
     }
-    if (length == lhs.size()) {
-        return -1;
-    } else {
-        return 1;
+    return (length == lhs.size()) ? -1 : 1;
+}
+
+/**
+ * Return the first 8 bytes as a big-endian integer, zero padded.
+ * Comparing two prefixes as integers gives the same order as comparing the bytes.
+ */
+static uint64_t string_prefix(const char* data, size_t size) {
+    uint64_t prefix = 0;
+    memcpy(&prefix, data, (size < sizeof(prefix)) ? size : sizeof(prefix));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    prefix = __builtin_bswap64(prefix);
+#endif
+    return prefix;
+}
+
+static uint64_t string_prefix(const string& str) {
+    return string_prefix(str.data(), str.size());
+}
+
+/**
+ * String with a cached normalized prefix.
+ * Sorting an array of PrefixString resolves most comparisons by one integer
+ * comparison, the string memory is only touched when the prefixes are equal.
+ * Update prefix by reset() after changing str.
+ */
+struct PrefixString {
+    uint64_t prefix;
+    string   str;
+
+    PrefixString() : prefix(0) {}
+    PrefixString(const string& s) : prefix(string_prefix(s)), str(s) {}
+
+    void reset(const string& s) {
+        str = s;
+        prefix = string_prefix(str);
+    }
+};
+
+/**
+ * Comparison function for PrefixString, same order as cmp<string>.
+ */
+template <>
+int cmp(const PrefixString& lhs, const PrefixString& rhs) {
+    if (lhs.prefix != rhs.prefix) {
+        return (lhs.prefix < rhs.prefix) ? -1 : 1;
+    }
+    // The head min(size, 8) bytes are equal.
+    size_t length = (lhs.str.size() > rhs.str.size()) ? rhs.str.size() : lhs.str.size();
+    if (length > sizeof(lhs.prefix)) {
+        int res = memcmp(lhs.str.data() + sizeof(lhs.prefix), rhs.str.data() + sizeof(rhs.prefix),
+                         length - sizeof(lhs.prefix));
+        if (res != 0) {
+            return (res < 0) ? -1 : 1;
+        }
+    }
+    if (lhs.str.size() == rhs.str.size()) {
+        return 0;
     }
+    return (length == lhs.str.size()) ? -1 : 1;
 }
 
 } // End namespace wttool.
@@ -0,0 +1,354 @@
+/**
+ * Concurrent string interning.
+ * Every distinct byte string gets a small integer id and a stable pointer
+ * into an arena, so repeated tokens are stored once and compared or hashed
+ * as integers. Lookups of interned strings are lock free, only inserting a
+ * new string takes the lock. Strings are never removed.
+ * E.g.,
+ *     StrInterner interner;
+ *     vector<uint32_t> ids;
+ *     interner.intern_split(line, " ", &ids);
+ *     StrView host = interner.get(ids[0]);
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_INTERNER_HPP_
+#define __WTTOOL_INTERNER_HPP_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "systool.hpp"
+#include "stloperation.hpp"
+
+#define INTERNER_CHUNK_SIZE (1 << 20)
+#define INTERNER_ID_BLOCK_BITS 16
+#define INTERNER_ID_BLOCKS 4096
+
+namespace wttool {
+
+using namespace std;
+
+/**
+ * 64-bit hash of bytes, 8 bytes a step.
+ */
+static uint64_t hash_bytes(const char* data, size_t size) {
+    const uint64_t mul = 0x9e3779b97f4a7c15ULL;
+    uint64_t h = size * mul;
+    while (size >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        h = (h ^ (word * mul)) * 0xff51afd7ed558ccdULL;
+        h ^= h >> 32;
+        data += 8;
+        size -= 8;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data, size);
+    h = (h ^ (tail * mul)) * 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 29;
+    return h;
+}
+
+class StrInterner {
+public:
+    /**
+     * @param reserved: The expected number of distinct strings.
+     */
+    StrInterner(size_t reserved = 1024) : _count(0), _chunk(nullptr), _chunk_used(0),
+        _chunk_size(0), _bytes(0) {
+        size_t capacity = 16;
+        while (capacity < reserved * 2) {
+            capacity *= 2;
+        }
+        _table.store(_new_table(capacity), std::memory_order_release);
+        for (size_t i = 0; i < INTERNER_ID_BLOCKS; ++i) {
+            _ids[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    virtual ~StrInterner() {
+        for (size_t i = 0; i < _tables.size(); ++i) {
+            delete[] _tables[i]->slots;
+            delete _tables[i];
+        }
+        for (size_t i = 0; i < INTERNER_ID_BLOCKS; ++i) {
+            delete[] _ids[i].load(std::memory_order_relaxed);
+        }
+        for (size_t i = 0; i < _chunks.size(); ++i) {
+            free(_chunks[i]);
+        }
+    }
+
+    /**
+     * Get the id of the string, add it if it is new.
+     * @return The id, ids are given from 0 in the order of adding.
+     */
+    uint32_t intern(const char* data, size_t size) {
+        uint64_t hash = hash_bytes(data, size);
+        const Record* rec = _find(_table.load(std::memory_order_acquire), data, size, hash);
+        if (rec != nullptr) {
+            return rec->id;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _insert(data, size, hash)->id;
+    }
+
+    uint32_t intern(const string& str) {
+        return intern(str.data(), str.size());
+    }
+
+    uint32_t intern(const StrView& str) {
+        return intern(str.data, str.size);
+    }
+
+    /**
+     * Intern n strings, the lock is taken at most once.
+     * @param ids: Holds n ids.
+     */
+    void intern_batch(const StrView* strs, size_t n, uint32_t* ids) {
+        Table* table = _table.load(std::memory_order_acquire);
+        vector<size_t> missed;
+        for (size_t i = 0; i < n; ++i) {
+            const Record* rec = _find(table, strs[i].data, strs[i].size,
+                                      hash_bytes(strs[i].data, strs[i].size));
+            if (rec == nullptr) {
+                missed.push_back(i);
+            } else {
+                ids[i] = rec->id;
+            }
+        }
+        if (missed.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 0; i < missed.size(); ++i) {
+            const StrView& str = strs[missed[i]];
+            ids[missed[i]] = _insert(str.data, str.size, hash_bytes(str.data, str.size))->id;
+        }
+    }
+
+    /**
+     * Split bytes by token as splitstr does and intern every field, without
+     * making any std::string.
+     * @param ids: Cleared and filled with the ids of the fields.
+     * @return The number of fields.
+     */
+    size_t intern_split(const char* data, size_t length, const string& token, vector<uint32_t>* ids) {
+        static thread_local vector<StrView> fields;
+        splitstr(data, length, token, &fields);
+        ids->resize(fields.size());
+        intern_batch(fields.data(), fields.size(), ids->data());
+        return ids->size();
+    }
+
+    size_t intern_split(const string& str, const string& token, vector<uint32_t>* ids) {
+        return intern_split(str.data(), str.size(), token, ids);
+    }
+
+    /**
+     * Find the id without adding.
+     * @return 0 means found.
+     */
+    int find(const char* data, size_t size, uint32_t* id) const {
+        const Record* rec = _find(_table.load(std::memory_order_acquire), data, size,
+                                  hash_bytes(data, size));
+        if (rec == nullptr) {
+            return -1;
+        }
+        *id = rec->id;
+        return 0;
+    }
+
+    int find(const string& str, uint32_t* id) const {
+        return find(str.data(), str.size(), id);
+    }
+
+    /**
+     * The string of the id, valid until the interner is destroyed.
+     * The bytes are followed by '\0'. An unknown id gives an empty view.
+     */
+    StrView get(uint32_t id) const {
+        const Record* rec = _record(id);
+        if (rec == nullptr) {
+            return StrView();
+        }
+        return StrView(rec->data, rec->size);
+    }
+
+    /**
+     * The hash of the id's string, as computed by hash_bytes.
+     */
+    uint64_t hash(uint32_t id) const {
+        const Record* rec = _record(id);
+        return (rec == nullptr) ? 0 : rec->hash;
+    }
+
+    /**
+     * The number of distinct strings.
+     */
+    size_t size() const {
+        return _count.load(std::memory_order_acquire);
+    }
+
+    /**
+     * The bytes held by the arena and the hash tables.
+     */
+    size_t memory() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        size_t res = _bytes;
+        for (size_t i = 0; i < _tables.size(); ++i) {
+            res += (_tables[i]->mask + 1) * sizeof(std::atomic<const Record*>);
+        }
+        return res;
+    }
+
+private:
+    struct Record {
+        uint64_t hash;
+        uint32_t id;
+        uint32_t size;
+        char     data[1];
+    };
+
+    struct Table {
+        size_t                         mask;
+        std::atomic<const Record*>*    slots;
+    };
+
+    // Readers use the newest table, old tables are kept alive for readers still on them.
+    std::atomic<Table*>          _table;
+    vector<Table*>               _tables;
+    std::atomic<uint32_t>        _count;
+    // Id to record, blocks of 1 << INTERNER_ID_BLOCK_BITS.
+    std::atomic<std::atomic<const Record*>*> _ids[INTERNER_ID_BLOCKS];
+    // Arena.
+    vector<char*>                _chunks;
+    char*                        _chunk;
+    size_t                       _chunk_used;
+    size_t                       _chunk_size;
+    size_t                       _bytes;
+    mutable std::mutex           _mutex;
+
+    StrInterner(const StrInterner&);
+    StrInterner& operator=(const StrInterner&);
+
+    Table* _new_table(size_t capacity) {
+        Table* table = new Table;
+        table->mask = capacity - 1;
+        table->slots = new std::atomic<const Record*>[capacity];
+        for (size_t i = 0; i < capacity; ++i) {
+            table->slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+        _tables.push_back(table);
+        return table;
+    }
+
+    static const Record* _find(const Table* table, const char* data, size_t size, uint64_t hash) {
+        for (size_t pos = hash & table->mask; ; pos = (pos + 1) & table->mask) {
+            const Record* rec = table->slots[pos].load(std::memory_order_acquire);
+            if (rec == nullptr) {
+                return nullptr;
+            }
+            if (rec->hash == hash && rec->size == size && memcmp(rec->data, data, size) == 0) {
+                return rec;
+            }
+        }
+    }
+
+    static void _put(Table* table, const Record* rec) {
+        size_t pos = rec->hash & table->mask;
+        while (table->slots[pos].load(std::memory_order_relaxed) != nullptr) {
+            pos = (pos + 1) & table->mask;
+        }
+        table->slots[pos].store(rec, std::memory_order_release);
+    }
+
+    const Record* _record(uint32_t id) const {
+        if (id >= _count.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        std::atomic<const Record*>* block = _ids[id >> INTERNER_ID_BLOCK_BITS].load(std::memory_order_acquire);
+        return block[id & ((1 << INTERNER_ID_BLOCK_BITS) - 1)].load(std::memory_order_acquire);
+    }
+
+    char* _alloc(size_t size) {
+        // Keep records 8 bytes aligned.
+        size = (size + 7) & ~(size_t)7;
+        if (_chunk == nullptr || _chunk_used + size > _chunk_size) {
+            _chunk_size = (size > INTERNER_CHUNK_SIZE) ? size : INTERNER_CHUNK_SIZE;
+            _chunk = (char*)malloc(_chunk_size);
+            if (_chunk == nullptr) {
+                toscreen << "Malloc interner arena failed.\n";
+                abort();
+            }
+            _chunks.push_back(_chunk);
+            _chunk_used = 0;
+            _bytes += _chunk_size;
+        }
+        char* res = _chunk + _chunk_used;
+        _chunk_used += size;
+        return res;
+    }
+
+    /**
+     * Find or add the string, must hold _mutex.
+     */
+    const Record* _insert(const char* data, size_t size, uint64_t hash) {
+        Table* table = _table.load(std::memory_order_relaxed);
+        const Record* found = _find(table, data, size, hash);
+        if (found != nullptr) {
+            return found;
+        }
+        uint32_t id = _count.load(std::memory_order_relaxed);
+        if ((id >> INTERNER_ID_BLOCK_BITS) >= INTERNER_ID_BLOCKS) {
+            toscreen << "Interner is out of the capacity.\n";
+            abort();
+        }
+        Record* rec = (Record*)_alloc(offsetof(Record, data) + size + 1);
+        rec->hash = hash;
+        rec->id = id;
+        rec->size = size;
+        memcpy(rec->data, data, size);
+        rec->data[size] = '\0';
+
+        size_t block_pos = id >> INTERNER_ID_BLOCK_BITS;
+        std::atomic<const Record*>* block = _ids[block_pos].load(std::memory_order_relaxed);
+        if (block == nullptr) {
+            block = new std::atomic<const Record*>[1 << INTERNER_ID_BLOCK_BITS];
+            _ids[block_pos].store(block, std::memory_order_release);
+        }
+        block[id & ((1 << INTERNER_ID_BLOCK_BITS) - 1)].store(rec, std::memory_order_release);
+        // The id must be valid for get() before any reader can find the record.
+        _count.store(id + 1, std::memory_order_release);
+
+        if ((id + 1) * 2 > table->mask + 1) {
+            // Keep the load factor under 0.5, readers switch to the new table.
+            Table* bigger = _new_table((table->mask + 1) * 2);
+            for (uint32_t i = 0; i < id; ++i) {
+                _put(bigger, _record_locked(i));
+            }
+            _put(bigger, rec);
+            _table.store(bigger, std::memory_order_release);
+        } else {
+            _put(table, rec);
+        }
+        return rec;
+    }
+
+    const Record* _record_locked(uint32_t id) const {
+        std::atomic<const Record*>* block = _ids[id >> INTERNER_ID_BLOCK_BITS].load(std::memory_order_relaxed);
+        return block[id & ((1 << INTERNER_ID_BLOCK_BITS) - 1)].load(std::memory_order_relaxed);
+    }
+};
+
+} // End namespace wttool.
+
+#endif // End ifdef __WTTOOL_INTERNER_HPP_.
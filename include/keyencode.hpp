@@ -0,0 +1,279 @@
+/**
+ * Order preserving key encoding.
+ * A tuple of integers, floats and strings is encoded into bytes, comparing
+ * two encoded keys by memcmp (cmp<string>) gives the same order as comparing
+ * the tuples field by field. Each field may be ascending or descending.
+ * The encoded keys do not depend on the host, they can be persisted.
+ * E.g.,
+ *     KeyEncoder enc;
+ *     enc.append_string(host);
+ *     enc.append_int64(time, true);   // Descending.
+ *     keys.push_back(enc.key());
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_KEYENCODE_H_
+#define __WTTOOL_KEYENCODE_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+namespace wttool {
+
+using namespace std;
+
+/**
+ * Build an encoded key field by field.
+ */
+class KeyEncoder {
+public:
+    KeyEncoder() {}
+
+    void clear() {
+        _key.clear();
+    }
+
+    /**
+     * The encoded key.
+     */
+    const string& key() const {
+        return _key;
+    }
+
+    /**
+     * The head 8 bytes of the key as a big-endian integer, zero padded.
+     * It preserves the order exactly if the key is not longer than 8 bytes,
+     * otherwise equal integers need to be resolved by the whole key.
+     */
+    uint64_t to_uint64() const {
+        return _head<uint64_t>();
+    }
+
+    /**
+     * The head 16 bytes of the key as a big-endian integer, zero padded.
+     */
+    unsigned __int128 to_uint128() const {
+        return _head<unsigned __int128>();
+    }
+
+    void append_uint64(uint64_t val, bool desc = false) {
+        _append_be(val, desc);
+    }
+
+    void append_uint32(uint32_t val, bool desc = false) {
+        _append_be(val, desc);
+    }
+
+    /**
+     * Flip the sign bit, so negative numbers sort before positive ones.
+     */
+    void append_int64(int64_t val, bool desc = false) {
+        _append_be((uint64_t)val ^ ((uint64_t)1 << 63), desc);
+    }
+
+    void append_int32(int32_t val, bool desc = false) {
+        _append_be((uint32_t)val ^ ((uint32_t)1 << 31), desc);
+    }
+
+    /**
+     * Negative numbers have all bits flipped, others have the sign bit flipped.
+     * -0.0 is encoded as 0.0, NaN sorts after +inf.
+     */
+    void append_double(double val, bool desc = false) {
+        if (val == 0) {
+            val = 0;
+        }
+        uint64_t bits;
+        memcpy(&bits, &val, sizeof(bits));
+        if (val != val) {
+            bits = 0x7ff8000000000000ULL;
+        }
+        bits = (bits >> 63) ? ~bits : (bits | ((uint64_t)1 << 63));
+        _append_be(bits, desc);
+    }
+
+    void append_float(float val, bool desc = false) {
+        if (val == 0) {
+            val = 0;
+        }
+        uint32_t bits;
+        memcpy(&bits, &val, sizeof(bits));
+        if (val != val) {
+            bits = 0x7fc00000U;
+        }
+        bits = (bits >> 31) ? ~bits : (bits | ((uint32_t)1 << 31));
+        _append_be(bits, desc);
+    }
+
+    /**
+     * Byte 0x00 is escaped to 0x00 0xff and the string ends with 0x00 0x01,
+     * so a string sorts before any longer string having it as prefix.
+     */
+    void append_string(const char* data, size_t size, bool desc = false) {
+        size_t begin = _key.size();
+        const char* end = data + size;
+        while (data < end) {
+            const char* zero = (const char*)memchr(data, 0, end - data);
+            if (zero == nullptr) {
+                _key.append(data, end - data);
+                break;
+            }
+            _key.append(data, zero - data);
+            _key.append("\x00\xff", 2);
+            data = zero + 1;
+        }
+        _key.append("\x00\x01", 2);
+        if (desc) {
+            _invert(begin);
+        }
+    }
+
+    void append_string(const string& str, bool desc = false) {
+        append_string(str.data(), str.size(), desc);
+    }
+
+private:
+    string _key;
+
+    template <typename U>
+    void _append_be(U val, bool desc) {
+        if (desc) {
+            val = ~val;
+        }
+        char buf[sizeof(U)];
+        for (size_t i = 0; i < sizeof(U); ++i) {
+            buf[i] = (char)(val >> (8 * (sizeof(U) - 1 - i)));
+        }
+        _key.append(buf, sizeof(U));
+    }
+
+    void _invert(size_t begin) {
+        for (size_t i = begin; i < _key.size(); ++i) {
+            _key[i] = ~_key[i];
+        }
+    }
+
+    template <typename U>
+    U _head() const {
+        U res = 0;
+        for (size_t i = 0; i < sizeof(U); ++i) {
+            res <<= 8;
+            if (i < _key.size()) {
+                res |= (unsigned char)_key[i];
+            }
+        }
+        return res;
+    }
+};
+
+/**
+ * Read the fields back from an encoded key, in the order and direction
+ * they were appended. Each function returns 0 means successfully, -1 means
+ * the key is too short or malformed.
+ */
+class KeyDecoder {
+public:
+    KeyDecoder(const char* data, size_t size) : _cur(data), _end(data + size) {}
+    KeyDecoder(const string& key) : _cur(key.data()), _end(key.data() + key.size()) {}
+
+    /**
+     * @return If all fields have been read.
+     */
+    bool done() const {
+        return _cur == _end;
+    }
+
+    int read_uint64(uint64_t* val, bool desc = false) {
+        return _read_be(val, desc);
+    }
+
+    int read_uint32(uint32_t* val, bool desc = false) {
+        return _read_be(val, desc);
+    }
+
+    int read_int64(int64_t* val, bool desc = false) {
+        uint64_t bits;
+        if (_read_be(&bits, desc) != 0) {
+            return -1;
+        }
+        *val = (int64_t)(bits ^ ((uint64_t)1 << 63));
+        return 0;
+    }
+
+    int read_int32(int32_t* val, bool desc = false) {
+        uint32_t bits;
+        if (_read_be(&bits, desc) != 0) {
+            return -1;
+        }
+        *val = (int32_t)(bits ^ ((uint32_t)1 << 31));
+        return 0;
+    }
+
+    int read_double(double* val, bool desc = false) {
+        uint64_t bits;
+        if (_read_be(&bits, desc) != 0) {
+            return -1;
+        }
+        bits = (bits >> 63) ? (bits & ~((uint64_t)1 << 63)) : ~bits;
+        memcpy(val, &bits, sizeof(bits));
+        return 0;
+    }
+
+    int read_float(float* val, bool desc = false) {
+        uint32_t bits;
+        if (_read_be(&bits, desc) != 0) {
+            return -1;
+        }
+        bits = (bits >> 31) ? (bits & ~((uint32_t)1 << 31)) : ~bits;
+        memcpy(val, &bits, sizeof(bits));
+        return 0;
+    }
+
+    int read_string(string* str, bool desc = false) {
+        unsigned char flip = desc ? 0xff : 0;
+        str->clear();
+        while (_cur < _end) {
+            unsigned char c = (unsigned char)*_cur++ ^ flip;
+            if (c != 0) {
+                str->push_back((char)c);
+                continue;
+            }
+            if (_cur == _end) {
+                return -1;
+            }
+            unsigned char next = (unsigned char)*_cur++ ^ flip;
+            if (next == 0x01) {
+                return 0;
+            }
+            if (next != 0xff) {
+                return -1;
+            }
+            str->push_back('\0');
+        }
+        return -1;
+    }
+
+private:
+    const char* _cur;
+    const char* _end;
+
+    template <typename U>
+    int _read_be(U* val, bool desc) {
+        if ((size_t)(_end - _cur) < sizeof(U)) {
+            return -1;
+        }
+        U res = 0;
+        for (size_t i = 0; i < sizeof(U); ++i) {
+            res = (U)((res << 8) | (unsigned char)_cur[i]);
+        }
+        _cur += sizeof(U);
+        *val = desc ? (U)~res : res;
+        return 0;
+    }
+};
+
+} // End namespace wttool.
+
+#endif // End ifdef __WTTOOL_KEYENCODE_H_.
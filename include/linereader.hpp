@@ -0,0 +1,524 @@
+/**
+ * Memory mapped file and zero-copy line reader.
+ * Regular files are mapped, pipes and other streams are read in large aligned
+ * blocks by a readahead thread. Lines are returned as StrView pointing into the
+ * mapping or the block, only a line spanning two blocks is copied.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_LINEREADER_H_
+#define __WTTOOL_LINEREADER_H_
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "systool.hpp"
+#include "stloperation.hpp"
+
+#define LINEREADER_BLOCK_SIZE (4 << 20)
+#define LINEREADER_ALIGN 4096
+
+namespace wttool {
+
+using namespace std;
+
+/**
+ * Read only mapping of a whole file.
+ */
+class MappedFile {
+public:
+    MappedFile() : _fd(-1), _data(nullptr), _size(0) {}
+    virtual ~MappedFile() {
+        close();
+    }
+
+    /**
+     * Map the file.
+     * @return 0 means successfully.
+     */
+    int open(const string& path) {
+        close();
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            toscreen << "Open file " << path << " failed: " << strerror(errno) << ".\n";
+            return -1;
+        }
+        return open_fd(fd);
+    }
+
+    /**
+     * Map a regular file opened by the caller. The fd is owned by the
+     * mapping afterwards, it is closed even if mapping failed.
+     * @return 0 means successfully.
+     */
+    int open_fd(int fd) {
+        close();
+        _fd = fd;
+        struct stat st;
+        if (fstat(_fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            toscreen << "Map fd " << fd << " failed: not a regular file.\n";
+            close();
+            return -1;
+        }
+        _size = st.st_size;
+        if (_size == 0) {
+            return 0;
+        }
+        void* addr = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+        if (addr == MAP_FAILED) {
+            toscreen << "Mmap fd " << fd << " failed: " << strerror(errno) << ".\n";
+            close();
+            return -1;
+        }
+        _data = (const char*)addr;
+        madvise(addr, _size, MADV_SEQUENTIAL);
+        madvise(addr, _size, MADV_WILLNEED);
+        return 0;
+    }
+
+    void close() {
+        if (_data != nullptr) {
+            munmap((void*)_data, _size);
+            _data = nullptr;
+        }
+        if (_fd >= 0) {
+            ::close(_fd);
+            _fd = -1;
+        }
+        _size = 0;
+    }
+
+    const char* data() const {
+        return _data;
+    }
+
+    size_t size() const {
+        return _size;
+    }
+
+    /**
+     * Split the file into about n ranges, each range begins at a line start
+     * and ends after a '\n' (or at the end of file), for parallel processing.
+     * Feed every range to LineReader::open_range.
+     * @return The number of ranges.
+     */
+    size_t split_lines(size_t n, vector<StrView>* ranges) const {
+        ranges->clear();
+        if (_size == 0) {
+            return 0;
+        }
+        if (n == 0) {
+            n = 1;
+        }
+        size_t chunk = _size / n + 1;
+        size_t begin = 0;
+        while (begin < _size) {
+            size_t end = begin + chunk;
+            if (end >= _size) {
+                end = _size;
+            } else {
+                const char* nl = (const char*)memchr(_data + end, '\n', _size - end);
+                end = (nl == nullptr) ? _size : (nl - _data + 1);
+            }
+            ranges->push_back(StrView(_data + begin, end - begin));
+            begin = end;
+        }
+        return ranges->size();
+    }
+
+private:
+    int         _fd;
+    const char* _data;
+    size_t      _size;
+
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
+
+/**
+ * Line reader over a mapped file, a byte range or a stream.
+ * Newlines are found by memchr, which is vectorized by the C library.
+ * A stream block is handed over as soon as no more input is ready, so lines
+ * of a slow producer, e.g., tail -f, are returned without waiting for a full block.
+ * E.g.,
+ *     LineReader reader;
+ *     reader.open("a.log");
+ *     StrView line;
+ *     while (reader.next(&line) == 0) { ... }
+ */
+class LineReader {
+public:
+    /**
+     * @param block_size: Size of each stream block, rounded up to 4KB.
+     */
+    LineReader(size_t block_size = LINEREADER_BLOCK_SIZE) :
+        _block_size((block_size + LINEREADER_ALIGN - 1) / LINEREADER_ALIGN * LINEREADER_ALIGN),
+        _mode(MODE_NONE), _range_done(false), _cur(nullptr), _cur_len(0), _pos(0),
+        _carry_used(false), _fd(-1), _own_fd(false), _stop(false), _eof(false),
+        _error(false), _next_fill(0), _next_take(0) {
+        if (_block_size == 0) {
+            _block_size = LINEREADER_ALIGN;
+        }
+        _bufs[0] = _bufs[1] = nullptr;
+        _lens[0] = _lens[1] = 0;
+        _wake[0] = _wake[1] = -1;
+        _filled[0] = _filled[1] = false;
+    }
+
+    virtual ~LineReader() {
+        close();
+    }
+
+    /**
+     * Open a file, mapped if it is a regular file, otherwise streamed.
+     * @return 0 means successfully.
+     */
+    int open(const string& path) {
+        close();
+        // Opened once, reopening a FIFO would drop what the writer has written.
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            toscreen << "Open file " << path << " failed: " << strerror(errno) << ".\n";
+            return -1;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            toscreen << "Stat file " << path << " failed: " << strerror(errno) << ".\n";
+            ::close(fd);
+            return -1;
+        }
+        if (S_ISREG(st.st_mode)) {
+            if (_file.open_fd(fd) != 0) {
+                return -1;
+            }
+            _mode = MODE_RANGE;
+            _range = StrView(_file.data(), _file.size());
+            return 0;
+        }
+        if (open_fd(fd) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        _own_fd = true;
+        return 0;
+    }
+
+    /**
+     * Stream from the fd, e.g., a pipe or stdin. The fd is not closed by the reader.
+     * @return 0 means successfully.
+     */
+    int open_fd(int fd) {
+        close();
+        for (int i = 0; i < 2; ++i) {
+            if (posix_memalign((void**)&_bufs[i], LINEREADER_ALIGN, _block_size) != 0) {
+                _bufs[i] = nullptr;
+                toscreen << "Malloc line reader block failed.\n";
+                close();
+                return -1;
+            }
+        }
+        // close() wakes the readahead thread by this pipe.
+        if (pipe2(_wake, O_CLOEXEC | O_NONBLOCK) != 0) {
+            _wake[0] = _wake[1] = -1;
+            toscreen << "Create wake pipe failed: " << strerror(errno) << ".\n";
+            close();
+            return -1;
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        _fd = fd;
+        _mode = MODE_STREAM;
+        _reader = std::thread(&LineReader::_read_loop, this);
+        return 0;
+    }
+
+    /**
+     * Read lines inside the byte range, e.g., one range from MappedFile::split_lines.
+     * @return 0 means successfully.
+     */
+    int open_range(const StrView& range) {
+        close();
+        _mode = MODE_RANGE;
+        _range = range;
+        return 0;
+    }
+
+    /**
+     * Get the next line without the trailing "\n" or "\r\n".
+     * The view is valid until the next call of next() or close().
+     * @return 0 means got a line, 1 means end of input, -1 means reading failed.
+     */
+    int next(StrView* line) {
+        if (_carry_used) {
+            _carry.clear();
+            _carry_used = false;
+        }
+        while (true) {
+            if (_cur == nullptr) {
+                int ret = _acquire();
+                if (ret != 0) {
+                    if (ret > 0 && !_carry.empty()) {
+                        // The last line has no '\n'.
+                        _carry_used = true;
+                        *line = _chomp(StrView(_carry));
+                        return 0;
+                    }
+                    return ret;
+                }
+            }
+            const char* begin = _cur + _pos;
+            size_t remain = _cur_len - _pos;
+            const char* nl = (const char*)memchr(begin, '\n', remain);
+            if (nl != nullptr) {
+                _pos += nl - begin + 1;
+                if (_carry.empty()) {
+                    *line = _chomp(StrView(begin, nl - begin));
+                } else {
+                    _carry.append(begin, nl - begin);
+                    _carry_used = true;
+                    *line = _chomp(StrView(_carry));
+                }
+                return 0;
+            }
+            // The line continues in the next block.
+            _carry.append(begin, remain);
+            _release();
+        }
+    }
+
+    void close() {
+        if (_mode == MODE_STREAM) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _cond.notify_all();
+            if (_wake[1] >= 0) {
+                char byte = 0;
+                while (write(_wake[1], &byte, 1) < 0 && errno == EINTR) {
+                }
+            }
+            if (_reader.joinable()) {
+                _reader.join();
+            }
+            if (_own_fd) {
+                ::close(_fd);
+            }
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (_wake[i] >= 0) {
+                ::close(_wake[i]);
+                _wake[i] = -1;
+            }
+        }
+        for (int i = 0; i < 2; ++i) {
+            free(_bufs[i]);
+            _bufs[i] = nullptr;
+            _lens[i] = 0;
+            _filled[i] = false;
+        }
+        _file.close();
+        _mode = MODE_NONE;
+        _range = StrView();
+        _range_done = false;
+        _cur = nullptr;
+        _cur_len = _pos = 0;
+        _carry.clear();
+        _carry_used = false;
+        _fd = -1;
+        _own_fd = false;
+        _stop = _eof = _error = false;
+        _next_fill = _next_take = 0;
+    }
+
+private:
+    enum Mode {
+        MODE_NONE,
+        MODE_RANGE,
+        MODE_STREAM
+    };
+
+    size_t      _block_size;
+    Mode        _mode;
+    MappedFile  _file;
+    StrView     _range;
+    bool        _range_done;
+
+    // The block being parsed.
+    const char* _cur;
+    size_t      _cur_len;
+    size_t      _pos;
+
+    // Holds a line spanning two blocks.
+    string      _carry;
+    bool        _carry_used;
+
+    // Stream mode, two blocks filled by _reader in turn.
+    int                     _fd;
+    bool                    _own_fd;
+    int                     _wake[2];
+    char*                   _bufs[2];
+    size_t                  _lens[2];
+    bool                    _filled[2];
+    bool                    _stop;
+    bool                    _eof;
+    bool                    _error;
+    int                     _next_fill;
+    int                     _next_take;
+    std::thread             _reader;
+    std::mutex              _mutex;
+    std::condition_variable _cond;
+
+    LineReader(const LineReader&);
+    LineReader& operator=(const LineReader&);
+
+    static StrView _chomp(StrView line) {
+        if (line.size != 0 && line.data[line.size - 1] == '\r') {
+            --line.size;
+        }
+        return line;
+    }
+
+    /**
+     * Get the next block to parse.
+     * @return 0 means successfully, 1 means end of input, -1 means reading failed.
+     */
+    int _acquire() {
+        _pos = 0;
+        if (_mode == MODE_RANGE) {
+            if (_range_done || _range.size == 0) {
+                return 1;
+            }
+            _range_done = true;
+            _cur = _range.data;
+            _cur_len = _range.size;
+            return 0;
+        }
+        if (_mode != MODE_STREAM) {
+            return -1;
+        }
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this] {
+            return _filled[_next_take] || _eof || _error;
+        });
+        if (!_filled[_next_take]) {
+            return _error ? -1 : 1;
+        }
+        _cur = _bufs[_next_take];
+        _cur_len = _lens[_next_take];
+        return 0;
+    }
+
+    /**
+     * Give the parsed block back to the readahead thread.
+     */
+    void _release() {
+        if (_mode == MODE_STREAM && _cur != nullptr) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _filled[_next_take] = false;
+                _next_take ^= 1;
+            }
+            _cond.notify_all();
+        }
+        _cur = nullptr;
+        _cur_len = _pos = 0;
+    }
+
+    /**
+     * Wait until the fd is readable or close() is called.
+     * @param timeout_ms: -1 means no timeout.
+     * @return 1 means readable, 0 means timed out, -1 means stopped.
+     */
+    int _wait_input(int timeout_ms) {
+        struct pollfd fds[2];
+        fds[0].fd = _fd;
+        fds[0].events = POLLIN;
+        fds[1].fd = _wake[0];
+        fds[1].events = POLLIN;
+        while (true) {
+            fds[0].revents = fds[1].revents = 0;
+            int res = poll(fds, 2, timeout_ms);
+            if (res < 0 && errno == EINTR) {
+                continue;
+            }
+            if (res < 0 || fds[1].revents != 0) {
+                // A failed poll leaves the error to read().
+                return (res < 0) ? 1 : -1;
+            }
+            return (res == 0) ? 0 : 1;
+        }
+    }
+
+    void _read_loop() {
+        while (true) {
+            char* buf = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cond.wait(lock, [this] {
+                    return !_filled[_next_fill] || _stop;
+                });
+                if (_stop) {
+                    return;
+                }
+                buf = _bufs[_next_fill];
+            }
+            size_t len = 0;
+            bool eof = false;
+            bool error = false;
+            while (len < _block_size) {
+                // Block for the first bytes, then only take what is ready.
+                int ready = _wait_input(len == 0 ? -1 : 0);
+                if (ready < 0) {
+                    return;
+                }
+                if (ready == 0) {
+                    break;
+                }
+                ssize_t n = ::read(_fd, buf + len, _block_size - len);
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n < 0) {
+                    toscreen << "Read failed: " << strerror(errno) << ".\n";
+                    error = true;
+                    break;
+                }
+                if (n == 0) {
+                    eof = true;
+                    break;
+                }
+                len += n;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (len != 0) {
+                    _lens[_next_fill] = len;
+                    _filled[_next_fill] = true;
+                    _next_fill ^= 1;
+                }
+                _eof = eof;
+                _error = error;
+            }
+            _cond.notify_all();
+            if (eof || error) {
+                return;
+            }
+        }
+    }
+};
+
+} // End namespace wttool.
+
+#endif // End ifdef __WTTOOL_LINEREADER_H_.
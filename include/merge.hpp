@@ -0,0 +1,436 @@
+/**
+ * K-way merge of sorted sequences by a loser tree.
+ * Each output element costs about log2(k) comparisons. Equal elements are
+ * output in the order of their sources, so the merge is stable.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_MERGE_HPP_
+#define __WTTOOL_MERGE_HPP_
+
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <iostream>
+
+#include "compare.hpp"
+#include "systool.hpp"
+
+#define MERGE_SOURCE_BLOCK 1024
+
+namespace wttool {
+
+using namespace std;
+
+/**
+ * A sorted source pulled by LoserTree block by block.
+ */
+template <typename T>
+class MergeSource {
+public:
+    virtual ~MergeSource() {}
+
+    /**
+     * Get the next block of elements.
+     * The block must stay valid until the next call of fill().
+     * @return 0 means got a non-empty block, -1 means exhausted.
+     */
+    virtual int fill(const T** begin, const T** end) = 0;
+};
+
+/**
+ * Source over a sorted array, the whole array is one block.
+ */
+template <typename T>
+class ArraySource : public MergeSource<T> {
+public:
+    ArraySource(const T* data = nullptr, int64_t length = 0) :
+        _data(data), _length(length), _done(false) {}
+
+    int fill(const T** begin, const T** end) {
+        if (_done || _length <= 0) {
+            return -1;
+        }
+        _done = true;
+        *begin = _data;
+        *end = _data + _length;
+        return 0;
+    }
+
+private:
+    const T* _data;
+    int64_t  _length;
+    bool     _done;
+};
+
+/**
+ * Source over a sorted range of input iterators, copied into blocks.
+ */
+template <typename T, typename Iter>
+class IterSource : public MergeSource<T> {
+public:
+    IterSource(Iter begin, Iter end) : _cur(begin), _end(end) {}
+
+    int fill(const T** begin, const T** end) {
+        _block.clear();
+        while (_cur != _end && _block.size() < MERGE_SOURCE_BLOCK) {
+            _block.push_back(*_cur);
+            ++_cur;
+        }
+        if (_block.empty()) {
+            return -1;
+        }
+        *begin = _block.data();
+        *end = _block.data() + _block.size();
+        return 0;
+    }
+
+private:
+    Iter      _cur;
+    Iter      _end;
+    vector<T> _block;
+};
+
+/**
+ * Loser tree over k sources.
+ * E.g.,
+ *     LoserTree<int64_t> tree;
+ *     tree.add_source(&source_1);
+ *     tree.add_source(&source_2);
+ *     tree.init();
+ *     int64_t val;
+ *     while (tree.next(&val) == 0) { ... }
+ */
+template <typename T>
+class LoserTree {
+public:
+    LoserTree(int (*compare)(const T& lhs, const T& rhs) = cmp<T>) :
+        _compare(compare), _k(0), _inited(false) {}
+    virtual ~LoserTree() {}
+
+    /**
+     * Add a source before init(), the source is not owned by the tree.
+     * @return 0 means successfully.
+     */
+    int add_source(MergeSource<T>* source) {
+        if (_inited || source == nullptr) {
+            return -1;
+        }
+        _sources.push_back(source);
+        return 0;
+    }
+
+    /**
+     * Pull the first block of every source and build the tree.
+     * @return 0 means successfully.
+     */
+    int init() {
+        if (_inited) {
+            return -1;
+        }
+        _inited = true;
+        _k = _sources.size();
+        if (_k == 0) {
+            return 0;
+        }
+        _cur.assign(_k, nullptr);
+        _end.assign(_k, nullptr);
+        for (int64_t i = 0; i < _k; ++i) {
+            _refill(i);
+        }
+        _tree.assign(_k, 0);
+        vector<int64_t> winner(2 * _k);
+        for (int64_t i = 0; i < _k; ++i) {
+            winner[_k + i] = i;
+        }
+        for (int64_t n = _k - 1; n >= 1; --n) {
+            int64_t l = winner[2 * n];
+            int64_t r = winner[2 * n + 1];
+            if (_beats(l, r)) {
+                winner[n] = l;
+                _tree[n] = r;
+            } else {
+                winner[n] = r;
+                _tree[n] = l;
+            }
+        }
+        _tree[0] = (_k == 1) ? 0 : winner[1];
+        return 0;
+    }
+
+    /**
+     * The smallest element, nullptr means all sources are exhausted.
+     */
+    const T* top() const {
+        if (_k == 0 || _cur[_tree[0]] == nullptr) {
+            return nullptr;
+        }
+        return _cur[_tree[0]];
+    }
+
+    /**
+     * The index of the source holding top(), in the order of add_source().
+     */
+    int64_t top_source() const {
+        return (_k == 0) ? -1 : _tree[0];
+    }
+
+    /**
+     * Remove the smallest element.
+     * @return 0 means successfully, -1 means empty.
+     */
+    int pop() {
+        if (top() == nullptr) {
+            return -1;
+        }
+        int64_t winner = _tree[0];
+        if (++_cur[winner] == _end[winner]) {
+            _refill(winner);
+        }
+        for (int64_t n = (winner + _k) / 2; n >= 1; n /= 2) {
+            if (_beats(_tree[n], winner)) {
+                std::swap(_tree[n], winner);
+            }
+        }
+        _tree[0] = winner;
+        return 0;
+    }
+
+    /**
+     * Copy and remove the smallest element.
+     * @return 0 means successfully, -1 means empty.
+     */
+    int next(T* val) {
+        const T* min = top();
+        if (min == nullptr) {
+            return -1;
+        }
+        *val = *min;
+        return pop();
+    }
+
+    /**
+     * Copy and remove up to max smallest elements.
+     * @return The number of elements copied, less than max means exhausted.
+     */
+    int64_t next_batch(T* out, int64_t max) {
+        int64_t count = 0;
+        while (count < max) {
+            const T* min = top();
+            if (min == nullptr) {
+                break;
+            }
+            out[count++] = *min;
+            pop();
+        }
+        return count;
+    }
+
+private:
+    int (*_compare)(const T& lhs, const T& rhs);
+    vector<MergeSource<T>*> _sources;
+    int64_t                 _k;
+    bool                    _inited;
+    // Current and end position of every source's block, _cur is nullptr if exhausted.
+    vector<const T*>        _cur;
+    vector<const T*>        _end;
+    // _tree[0] is the winner, others are the losers of inner nodes.
+    vector<int64_t>         _tree;
+
+    void _refill(int64_t i) {
+        if (_sources[i]->fill(&_cur[i], &_end[i]) != 0 || _cur[i] == _end[i]) {
+            _cur[i] = _end[i] = nullptr;
+        }
+    }
+
+    /**
+     * If source a's head goes out before source b's head.
+     * Exhausted sources lose, ties go to the lower index.
+     */
+    bool _beats(int64_t a, int64_t b) const {
+        if (_cur[b] == nullptr) {
+            return _cur[a] != nullptr || a < b;
+        }
+        if (_cur[a] == nullptr) {
+            return false;
+        }
+        int res = _compare(*_cur[a], *_cur[b]);
+        return res < 0 || (res == 0 && a < b);
+    }
+};
+
+/**
+ * Merge k sorted arrays into out.
+ * @param seqs, lengths: The k arrays and their lengths.
+ * @param out: Must hold the sum of lengths elements.
+ * @return The number of elements written.
+ */
+template <typename T>
+static int64_t kmerge(const T* const* seqs,
+                      const int64_t* lengths,
+                      int64_t k,
+                      T* out,
+                      int (*compare)(const T& lhs, const T& rhs) = cmp<T>) {
+    vector<ArraySource<T> > sources;
+    sources.reserve(k);
+    LoserTree<T> tree(compare);
+    int64_t total = 0;
+    for (int64_t i = 0; i < k; ++i) {
+        sources.push_back(ArraySource<T>(seqs[i], lengths[i]));
+        total += lengths[i];
+    }
+    for (int64_t i = 0; i < k; ++i) {
+        tree.add_source(&sources[i]);
+    }
+    tree.init();
+    return tree.next_batch(out, total);
+}
+
+/**
+ * Co-ranking, find how many elements of every array go before the rank-th
+ * element of the merged output, in the same order as kmerge.
+ * Multi-sequence selection: every array keeps a window holding its answer,
+ * each round takes the weighted median of the window middles as the pivot,
+ * ranks it by a binary search in every array and cuts the windows by it.
+ * A round drops at least a quarter of the window elements, so it is
+ * O(log(n)) rounds of O(k * log(n)) comparisons.
+ * @param pos: Filled with k positions, their sum is rank.
+ */
+template <typename T>
+static void kmerge_corank(const T* const* seqs,
+                          const int64_t* lengths,
+                          int64_t k,
+                          int64_t rank,
+                          int64_t* pos,
+                          int (*compare)(const T& lhs, const T& rhs) = cmp<T>) {
+    // The answer of array i is in [pos[i], hi[i]].
+    vector<int64_t> hi(k);
+    for (int64_t i = 0; i < k; ++i) {
+        pos[i] = 0;
+        hi[i] = (lengths[i] < rank) ? lengths[i] : rank;
+    }
+    vector<int64_t> mids;
+    mids.reserve(k);
+    vector<int64_t> counts(k);
+    while (true) {
+        // Middles of the non-empty windows, ordered as kmerge outputs them.
+        mids.clear();
+        int64_t weight = 0;
+        for (int64_t i = 0; i < k; ++i) {
+            if (pos[i] < hi[i]) {
+                mids.push_back(i);
+                weight += hi[i] - pos[i];
+            }
+        }
+        if (mids.empty()) {
+            return;
+        }
+        std::sort(mids.begin(), mids.end(), [&](int64_t a, int64_t b) {
+            int res = compare(seqs[a][pos[a] + (hi[a] - pos[a]) / 2],
+                              seqs[b][pos[b] + (hi[b] - pos[b]) / 2]);
+            return res < 0 || (res == 0 && a < b);
+        });
+        // The weighted median, half of the window elements are in windows whose
+        // middle is not after it, so at least a quarter is not after it, and
+        // the same for not before it.
+        size_t median = 0;
+        int64_t sum = hi[mids[0]] - pos[mids[0]];
+        while (sum * 2 < weight) {
+            ++median;
+            sum += hi[mids[median]] - pos[mids[median]];
+        }
+        int64_t i = mids[median];
+        int64_t mid = pos[i] + (hi[i] - pos[i]) / 2;
+        const T& key = seqs[i][mid];
+        int64_t key_rank = 0;
+        for (int64_t j = 0; j < k; ++j) {
+            if (j == i) {
+                counts[j] = mid;
+            } else {
+                // Equal elements of lower arrays go first.
+                int64_t l = 0;
+                int64_t h = lengths[j];
+                while (l < h) {
+                    int64_t m = l + (h - l) / 2;
+                    int res = compare(seqs[j][m], key);
+                    if (res < 0 || (res == 0 && j < i)) {
+                        l = m + 1;
+                    } else {
+                        h = m;
+                    }
+                }
+                counts[j] = l;
+            }
+            key_rank += counts[j];
+        }
+        // The key and all before it go before rank, or the key and all after it do not.
+        if (key_rank < rank) {
+            for (int64_t j = 0; j < k; ++j) {
+                pos[j] = (counts[j] > pos[j]) ? counts[j] : pos[j];
+            }
+            pos[i] = mid + 1;
+        } else {
+            for (int64_t j = 0; j < k; ++j) {
+                hi[j] = (counts[j] < hi[j]) ? counts[j] : hi[j];
+            }
+            hi[i] = mid;
+        }
+    }
+}
+
+/**
+ * Merge k sorted arrays into out by several threads.
+ * The output is split into equal slices by co-ranking, each thread merges
+ * its own slice. The result is the same as kmerge.
+ * @return The number of elements written.
+ */
+template <typename T>
+static int64_t kmerge_parallel(const T* const* seqs,
+                               const int64_t* lengths,
+                               int64_t k,
+                               T* out,
+                               int threads,
+                               int (*compare)(const T& lhs, const T& rhs) = cmp<T>) {
+    int64_t total = 0;
+    for (int64_t i = 0; i < k; ++i) {
+        total += lengths[i];
+    }
+    if (threads <= 1 || total < threads) {
+        return kmerge(seqs, lengths, k, out, compare);
+    }
+    // Split positions of every slice boundary, boundary t at row t.
+    vector<int64_t> bounds((threads + 1) * k, 0);
+    for (int64_t i = 0; i < k; ++i) {
+        bounds[threads * k + i] = lengths[i];
+    }
+    vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.push_back(std::thread([=, &bounds] {
+            kmerge_corank(seqs, lengths, k, total * t / threads, &bounds[t * k], compare);
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    workers.clear();
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([=, &bounds] {
+            vector<const T*> sub_seqs(k);
+            vector<int64_t> sub_lengths(k);
+            for (int64_t i = 0; i < k; ++i) {
+                sub_seqs[i] = seqs[i] + bounds[t * k + i];
+                sub_lengths[i] = bounds[(t + 1) * k + i] - bounds[t * k + i];
+            }
+            kmerge(sub_seqs.data(), sub_lengths.data(), k, out + total * t / threads, compare);
+        }));
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    return total;
+}
+
+} // End namespace wttool.
+
+#endif // End ifdef __WTTOOL_MERGE_HPP_.
@@ -0,0 +1,417 @@
+/**
+ * Read only search indexes over a sorted array.
+ * The sorted array is copied into a cache friendly layout, searches return
+ * positions in the original sorted array, so they work as drop-in
+ * replacements of binary search. Only the keys are stored, the position of
+ * the node found is computed from its index, since both trees are complete.
+ * EytzingerIndex: BFS layout, branchless search prefetching 4 levels ahead.
+ * BTreeIndex: implicit static B-tree with B keys per node, about log_(B+1)(n)
+ * cache misses per search.
+ * Elements are compared by the Compare template argument, cmp<T> by default,
+ * so the comparison is inlined.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_SEARCHINDEX_HPP_
+#define __WTTOOL_SEARCHINDEX_HPP_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <new>
+#include <utility>
+
+#include "compare.hpp"
+#include "systool.hpp"
+
+#define SEARCHINDEX_ALIGN 64
+// Queries interleaved by the batch searches.
+#define SEARCHINDEX_BATCH 16
+
+namespace wttool {
+
+using namespace std;
+
+/**
+ * Cache line aligned array of T.
+ * Do not use outside.
+ */
+template <typename T>
+class _AlignedArray {
+public:
+    _AlignedArray() : _data(nullptr), _length(0) {}
+    ~_AlignedArray() {
+        reset(0);
+    }
+
+    /**
+     * Reallocate length default constructed elements.
+     * @return 0 means successfully.
+     */
+    int reset(int64_t length) {
+        for (int64_t i = 0; i < _length; ++i) {
+            _data[i].~T();
+        }
+        free(_data);
+        _data = nullptr;
+        _length = 0;
+        if (length == 0) {
+            return 0;
+        }
+        if (posix_memalign((void**)&_data, SEARCHINDEX_ALIGN, sizeof(T) * length) != 0) {
+            _data = nullptr;
+            toscreen << "Malloc search index failed.\n";
+            return -1;
+        }
+        for (int64_t i = 0; i < length; ++i) {
+            new (_data + i) T();
+        }
+        _length = length;
+        return 0;
+    }
+
+    T& operator[](int64_t i) {
+        return _data[i];
+    }
+    const T& operator[](int64_t i) const {
+        return _data[i];
+    }
+    const T* data() const {
+        return _data;
+    }
+
+private:
+    T*      _data;
+    int64_t _length;
+
+    _AlignedArray(const _AlignedArray&);
+    _AlignedArray& operator=(const _AlignedArray&);
+};
+
+/**
+ * Eytzinger layout, node k has children 2k and 2k + 1, the root is 1.
+ * The data must be sorted by Compare.
+ */
+template <typename T, int (*Compare)(const T& lhs, const T& rhs) = cmp<T> >
+class EytzingerIndex {
+public:
+    EytzingerIndex() : _length(0), _height(0), _last(0) {}
+    virtual ~EytzingerIndex() {}
+
+    /**
+     * Build from a sorted array, the array is not needed afterwards.
+     * @return 0 means successfully.
+     */
+    int build(const T* data, int64_t length) {
+        _length = 0;
+        if (_keys.reset(length + 1) != 0) {
+            return -1;
+        }
+        _length = length;
+        _height = (length == 0) ? 0 : 64 - __builtin_clzll(length);
+        _last = (length == 0) ? 0 : 2 * (length - ((int64_t)1 << (_height - 1)) + 1);
+        int64_t next = 0;
+        _build(data, 1, &next);
+        return 0;
+    }
+
+    int64_t size() const {
+        return _length;
+    }
+
+    /**
+     * The position of the first element not less than key, size() if none.
+     */
+    int64_t lower_bound(const T& key) const {
+        return _search(key, false);
+    }
+
+    /**
+     * The position of the first element greater than key, size() if none.
+     */
+    int64_t upper_bound(const T& key) const {
+        return _search(key, true);
+    }
+
+    /**
+     * The positions [first, second) of the elements equal to key.
+     */
+    pair<int64_t, int64_t> equal_range(const T& key) const {
+        return make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    /**
+     * lower_bound of count keys, the searches are interleaved to overlap cache misses.
+     * @param res: Holds count positions.
+     */
+    void lower_bound_batch(const T* keys, int64_t count, int64_t* res) const {
+        _search_batch(keys, count, res, false);
+    }
+
+    void upper_bound_batch(const T* keys, int64_t count, int64_t* res) const {
+        _search_batch(keys, count, res, true);
+    }
+
+private:
+    _AlignedArray<T> _keys;
+    int64_t          _length;
+    // The number of levels, and twice the nodes on the last level.
+    int64_t          _height;
+    int64_t          _last;
+
+    // In order traversal gives the sorted order.
+    void _build(const T* data, int64_t k, int64_t* next) {
+        if (k > _length) {
+            return;
+        }
+        _build(data, 2 * k, next);
+        _keys[k] = data[(*next)++];
+        _build(data, 2 * k + 1, next);
+    }
+
+    /**
+     * The in order position of node k. In the perfect tree of _height levels
+     * node j of level d is at (2j + 1) * 2^(_height - 1 - d) - 1, and the
+     * missing nodes of the last level are at the even positions from _last.
+     */
+    int64_t _position(int64_t k) const {
+        int64_t shift = _height - 64 + __builtin_clzll(k);
+        int64_t pos = ((2 * k + 1) << shift) - ((int64_t)1 << _height) - 1;
+        return (pos < _last) ? pos : pos - (pos - _last + 1) / 2;
+    }
+
+    /**
+     * Go right if the node is less than key, or not greater than key if upper.
+     */
+    static int64_t _step(const T& node, const T& key, bool upper) {
+        int res = Compare(node, key);
+        return upper ? (res <= 0) : (res < 0);
+    }
+
+    /**
+     * Node k was reached by going right and then left while the trailing ones
+     * are right steps, dropping them and the last left step gives the answer.
+     */
+    int64_t _resolve(int64_t k) const {
+        k >>= __builtin_ffsll(~k);
+        return (k == 0) ? _length : _position(k);
+    }
+
+    int64_t _search(const T& key, bool upper) const {
+        // 64 bytes are 4 levels below for 4-byte keys.
+        const int64_t ahead = (SEARCHINDEX_ALIGN / sizeof(T) > 1) ? SEARCHINDEX_ALIGN / sizeof(T) : 1;
+        int64_t k = 1;
+        while (k <= _length) {
+            __builtin_prefetch(_keys.data() + k * ahead);
+            k = 2 * k + _step(_keys[k], key, upper);
+        }
+        return _resolve(k);
+    }
+
+    void _search_batch(const T* keys, int64_t count, int64_t* res, bool upper) const {
+        int64_t k[SEARCHINDEX_BATCH];
+        for (int64_t begin = 0; begin < count; begin += SEARCHINDEX_BATCH) {
+            int64_t n = (count - begin < SEARCHINDEX_BATCH) ? count - begin : SEARCHINDEX_BATCH;
+            for (int64_t q = 0; q < n; ++q) {
+                k[q] = 1;
+            }
+            bool running = true;
+            while (running) {
+                running = false;
+                for (int64_t q = 0; q < n; ++q) {
+                    if (k[q] <= _length) {
+                        k[q] = 2 * k[q] + _step(_keys[k[q]], keys[begin + q], upper);
+                        __builtin_prefetch(_keys.data() + (k[q] <= _length ? k[q] : 0));
+                        running = true;
+                    }
+                }
+            }
+            for (int64_t q = 0; q < n; ++q) {
+                res[begin + q] = _resolve(k[q]);
+            }
+        }
+    }
+};
+
+/**
+ * Implicit static B-tree, node k holds B sorted keys and has children
+ * k * (B + 1) + 1 to k * (B + 1) + B + 1. The last node is padded.
+ * The data must be sorted by Compare.
+ */
+template <typename T, int B = 16, int (*Compare)(const T& lhs, const T& rhs) = cmp<T> >
+class BTreeIndex {
+public:
+    BTreeIndex() : _length(0), _nodes(0), _height(0) {}
+    virtual ~BTreeIndex() {}
+
+    /**
+     * Build from a sorted array, the array is not needed afterwards.
+     * @return 0 means successfully.
+     */
+    int build(const T* data, int64_t length) {
+        _length = 0;
+        _nodes = (length + B - 1) / B;
+        if (_keys.reset(_nodes * B) != 0) {
+            _nodes = 0;
+            return -1;
+        }
+        _length = length;
+        // Level d starts at node ((B + 1)^d - 1) / B.
+        _height = 0;
+        _power[0] = 1;
+        _level_first[0] = 0;
+        while (_level_first[_height] < _nodes) {
+            _power[_height + 1] = _power[_height] * (B + 1);
+            _level_first[_height + 1] = _level_first[_height] + _power[_height];
+            ++_height;
+        }
+        int64_t next = 0;
+        _build(data, 0, &next);
+        return 0;
+    }
+
+    int64_t size() const {
+        return _length;
+    }
+
+    /**
+     * The position of the first element not less than key, size() if none.
+     */
+    int64_t lower_bound(const T& key) const {
+        return _search(key, false);
+    }
+
+    /**
+     * The position of the first element greater than key, size() if none.
+     */
+    int64_t upper_bound(const T& key) const {
+        return _search(key, true);
+    }
+
+    /**
+     * The positions [first, second) of the elements equal to key.
+     */
+    pair<int64_t, int64_t> equal_range(const T& key) const {
+        return make_pair(lower_bound(key), upper_bound(key));
+    }
+
+    /**
+     * lower_bound of count keys, the searches are interleaved to overlap cache misses.
+     * @param res: Holds count positions.
+     */
+    void lower_bound_batch(const T* keys, int64_t count, int64_t* res) const {
+        _search_batch(keys, count, res, false);
+    }
+
+    void upper_bound_batch(const T* keys, int64_t count, int64_t* res) const {
+        _search_batch(keys, count, res, true);
+    }
+
+private:
+    _AlignedArray<T> _keys;
+    int64_t          _length;
+    int64_t          _nodes;
+    // The number of levels, (B + 1)^d and the first node of level d.
+    int64_t          _height;
+    int64_t          _power[64];
+    int64_t          _level_first[64];
+
+    static int64_t _child(int64_t k, int64_t i) {
+        return k * (B + 1) + i + 1;
+    }
+
+    // In order traversal gives the sorted order, the padding goes last
+    // and repeats the biggest element, so it is never the first match.
+    void _build(const T* data, int64_t k, int64_t* next) {
+        if (k >= _nodes) {
+            return;
+        }
+        for (int64_t i = 0; i < B; ++i) {
+            _build(data, _child(k, i), next);
+            _keys[k * B + i] = data[(*next < _length) ? *next : _length - 1];
+            ++*next;
+        }
+        _build(data, _child(k, B), next);
+    }
+
+    /**
+     * The in order position of the slot on level depth, _length for padding.
+     * In the perfect tree of _height levels, a subtree of h levels holds
+     * (B + 1)^h - 1 keys and the subtrees on a level are one key apart.
+     * The missing leaves are B keys each, (B + 1) apart from the first one
+     * not built, every one before the slot is taken off.
+     */
+    int64_t _position(int64_t slot, int64_t depth) const {
+        if (slot < 0) {
+            return _length;
+        }
+        int64_t j = slot / B - _level_first[depth];
+        int64_t i = slot % B;
+        int64_t below = _power[_height - depth - 1] - 1;
+        int64_t pos = j * _power[_height - depth] + (i + 1) * below + i;
+        int64_t missing = (pos == 0) ? 0 : (pos - 1) / (B + 1) + 1 - (_nodes - _level_first[_height - 1]);
+        pos -= (missing > 0) ? missing * B : 0;
+        return (pos < _length) ? pos : _length;
+    }
+
+    /**
+     * The number of keys of node k less than key, or not greater than key if upper.
+     */
+    int64_t _rank(int64_t k, const T& key, bool upper) const {
+        const T* node = _keys.data() + k * B;
+        int64_t count = 0;
+        for (int64_t i = 0; i < B; ++i) {
+            int res = Compare(node[i], key);
+            count += upper ? (res <= 0) : (res < 0);
+        }
+        return count;
+    }
+
+    int64_t _search(const T& key, bool upper) const {
+        // The slot of the last match and its level.
+        int64_t slot = -1;
+        int64_t slot_depth = 0;
+        int64_t k = 0;
+        for (int64_t depth = 0; k < _nodes; ++depth) {
+            int64_t i = _rank(k, key, upper);
+            slot = (i < B) ? k * B + i : slot;
+            slot_depth = (i < B) ? depth : slot_depth;
+            k = _child(k, i);
+        }
+        return _position(slot, slot_depth);
+    }
+
+    void _search_batch(const T* keys, int64_t count, int64_t* res, bool upper) const {
+        int64_t k[SEARCHINDEX_BATCH];
+        int64_t slot[SEARCHINDEX_BATCH];
+        int64_t slot_depth[SEARCHINDEX_BATCH];
+        for (int64_t begin = 0; begin < count; begin += SEARCHINDEX_BATCH) {
+            int64_t n = (count - begin < SEARCHINDEX_BATCH) ? count - begin : SEARCHINDEX_BATCH;
+            for (int64_t q = 0; q < n; ++q) {
+                k[q] = 0;
+                slot[q] = -1;
+                slot_depth[q] = 0;
+            }
+            // Every level is searched for all queries before going down.
+            for (int64_t depth = 0; depth < _height; ++depth) {
+                for (int64_t q = 0; q < n; ++q) {
+                    if (k[q] >= _nodes) {
+                        continue;
+                    }
+                    int64_t i = _rank(k[q], keys[begin + q], upper);
+                    slot[q] = (i < B) ? k[q] * B + i : slot[q];
+                    slot_depth[q] = (i < B) ? depth : slot_depth[q];
+                    k[q] = _child(k[q], i);
+                    __builtin_prefetch(_keys.data() + ((k[q] < _nodes) ? k[q] * B : 0));
+                }
+            }
+            for (int64_t q = 0; q < n; ++q) {
+                res[begin + q] = _position(slot[q], slot_depth[q]);
+            }
+        }
+    }
+};
+
+} // End namespace wttool.
+
+#endif // End ifdef __WTTOOL_SEARCHINDEX_HPP_.
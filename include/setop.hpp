@@ -0,0 +1,355 @@
+/**
+ * Set operations over sorted arrays of unsigned integers, e.g., ID lists.
+ * Inputs must be sorted ascending and, except for unique_sorted, without
+ * duplicates. Outputs are written into caller buffers and are sorted and
+ * without duplicates too.
+ * Inputs of similar sizes are scanned by blocks (SSE2 for uint32_t),
+ * skewed sizes use galloping search in the bigger input.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_SETOP_HPP_
+#define __WTTOOL_SETOP_HPP_
+
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Use galloping search when the bigger input is this many times bigger.
+#define SETOP_GALLOP_RATIO 32
+
+namespace wttool {
+
+using namespace std;
+
+/**
+ * The first position p >= lo with data[p] >= key, n if none.
+ */
+template <typename T>
+static int64_t _setop_gallop(const T* data, int64_t lo, int64_t n, T key) {
+    if (lo >= n || data[lo] >= key) {
+        return lo;
+    }
+    // data[lo] < key.
+    int64_t step = 1;
+    int64_t hi = lo + 1;
+    while (hi < n && data[hi] < key) {
+        lo = hi;
+        step *= 2;
+        hi = lo + step;
+    }
+    if (hi > n) {
+        hi = n;
+    }
+    // data[lo] < key, data[hi] >= key or hi == n.
+    while (hi - lo > 1) {
+        int64_t mid = lo + (hi - lo) / 2;
+        if (data[mid] < key) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return hi;
+}
+
+/**
+ * Scalar merge intersection starting at a[i], b[j].
+ * Do not use outside.
+ */
+template <typename T>
+static int64_t _intersect_scalar(const T* a, int64_t na, int64_t i,
+                                 const T* b, int64_t nb, int64_t j,
+                                 T* out, int64_t k) {
+    while (i < na && j < nb) {
+        T x = a[i];
+        T y = b[j];
+        out[k] = x;
+        k += (x == y);
+        i += (x <= y);
+        j += (y <= x);
+    }
+    return k;
+}
+
+/**
+ * Block intersection, the generic version falls back to scalar merge.
+ * Do not use outside.
+ */
+template <typename T>
+static int64_t _intersect_block(const T* a, int64_t na, const T* b, int64_t nb, T* out) {
+    return _intersect_scalar(a, na, 0, b, nb, 0, out, 0);
+}
+
+/**
+ * Scalar difference a - b starting at a[i], b[j].
+ * Do not use outside.
+ */
+template <typename T>
+static int64_t _difference_scalar(const T* a, int64_t na, int64_t i,
+                                  const T* b, int64_t nb, int64_t j,
+                                  T* out, int64_t k) {
+    while (i < na && j < nb) {
+        T x = a[i];
+        T y = b[j];
+        out[k] = x;
+        k += (x < y);
+        i += (x <= y);
+        j += (y <= x);
+    }
+    while (i < na) {
+        out[k++] = a[i++];
+    }
+    return k;
+}
+
+/**
+ * Block difference, the generic version falls back to scalar merge.
+ * Do not use outside.
+ */
+template <typename T>
+static int64_t _difference_block(const T* a, int64_t na, const T* b, int64_t nb, T* out) {
+    return _difference_scalar(a, na, 0, b, nb, 0, out, 0);
+}
+
+#ifdef __SSE2__
+/**
+ * Compare 4 elements of a with 4 elements of b all against all.
+ * @return Bit x is set if a[x] is in b[0, 4).
+ */
+static inline int _setop_match4(const uint32_t* a, const uint32_t* b) {
+    __m128i va = _mm_loadu_si128((const __m128i*)a);
+    __m128i vb = _mm_loadu_si128((const __m128i*)b);
+    __m128i m0 = _mm_cmpeq_epi32(va, vb);
+    __m128i m1 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)));
+    __m128i m2 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2)));
+    __m128i m3 = _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)));
+    __m128i m = _mm_or_si128(_mm_or_si128(m0, m1), _mm_or_si128(m2, m3));
+    return _mm_movemask_ps(_mm_castsi128_ps(m));
+}
+
+/**
+ * SSE2 intersection for uint32_t, 4 by 4 blocks.
+ * Do not use outside.
+ */
+static inline int64_t _intersect_block(const uint32_t* a, int64_t na,
+                                       const uint32_t* b, int64_t nb, uint32_t* out) {
+    int64_t i = 0;
+    int64_t j = 0;
+    int64_t k = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        int mask = _setop_match4(a + i, b + j);
+        while (mask != 0) {
+            out[k++] = a[i + __builtin_ctz(mask)];
+            mask &= mask - 1;
+        }
+        uint32_t a_max = a[i + 3];
+        uint32_t b_max = b[j + 3];
+        i += (a_max <= b_max) ? 4 : 0;
+        j += (b_max <= a_max) ? 4 : 0;
+    }
+    return _intersect_scalar(a, na, i, b, nb, j, out, k);
+}
+
+/**
+ * SSE2 difference for uint32_t, 4 by 4 blocks.
+ * Do not use outside.
+ */
+static inline int64_t _difference_block(const uint32_t* a, int64_t na,
+                                        const uint32_t* b, int64_t nb, uint32_t* out) {
+    int64_t i = 0;
+    int64_t j = 0;
+    int64_t k = 0;
+    // Matched elements of the current a block, collected over several b blocks.
+    int matched = 0;
+    while (i + 4 <= na && j + 4 <= nb) {
+        matched |= _setop_match4(a + i, b + j);
+        uint32_t a_max = a[i + 3];
+        uint32_t b_max = b[j + 3];
+        if (a_max <= b_max) {
+            for (int x = 0; x < 4; ++x) {
+                out[k] = a[i + x];
+                k += ((matched >> x) & 1) ^ 1;
+            }
+            matched = 0;
+            i += 4;
+        }
+        j += (b_max <= a_max) ? 4 : 0;
+    }
+    if (matched != 0) {
+        // Drop the matched elements of the current a block, the others
+        // have no match before b[j].
+        for (int x = 0; x < 4; ++x, ++i) {
+            if ((matched >> x) & 1) {
+                continue;
+            }
+            while (j < nb && b[j] < a[i]) {
+                ++j;
+            }
+            if (j == nb || b[j] != a[i]) {
+                out[k++] = a[i];
+            }
+        }
+    }
+    return _difference_scalar(a, na, i, b, nb, j, out, k);
+}
+#endif
+
+/**
+ * Remove duplicates of a sorted array.
+ * @param out: Holds at least length elements, may be the same as in.
+ * @return The number of elements written.
+ */
+template <typename T>
+static int64_t unique_sorted(const T* in, int64_t length, T* out) {
+    if (length <= 0) {
+        return 0;
+    }
+    T prev = in[0];
+    out[0] = prev;
+    int64_t k = 1;
+    for (int64_t i = 1; i < length; ++i) {
+        T cur = in[i];
+        out[k] = cur;
+        k += (cur != prev);
+        prev = cur;
+    }
+    return k;
+}
+
+/**
+ * Intersection of two sorted sets.
+ * @param out: Holds at least min(na, nb) elements, must not overlap a or b.
+ * @return The number of elements written.
+ */
+template <typename T>
+static int64_t intersect_sorted(const T* a, int64_t na, const T* b, int64_t nb, T* out) {
+    if (na <= 0 || nb <= 0) {
+        return 0;
+    }
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (nb / na < SETOP_GALLOP_RATIO) {
+        return _intersect_block(a, na, b, nb, out);
+    }
+    int64_t k = 0;
+    int64_t pos = 0;
+    for (int64_t i = 0; i < na && pos < nb; ++i) {
+        pos = _setop_gallop(b, pos, nb, a[i]);
+        if (pos < nb && b[pos] == a[i]) {
+            out[k++] = a[i];
+        }
+    }
+    return k;
+}
+
+/**
+ * Union of two sorted sets.
+ * @param out: Holds at least na + nb elements, must not overlap a or b.
+ * @return The number of elements written.
+ */
+template <typename T>
+static int64_t union_sorted(const T* a, int64_t na, const T* b, int64_t nb, T* out) {
+    int64_t i = 0;
+    int64_t j = 0;
+    int64_t k = 0;
+    while (i < na && j < nb) {
+        T x = a[i];
+        T y = b[j];
+        out[k++] = (x < y) ? x : y;
+        i += (x <= y);
+        j += (y <= x);
+    }
+    if (i < na) {
+        memmove(out + k, a + i, sizeof(T) * (na - i));
+        k += na - i;
+    }
+    if (j < nb) {
+        memmove(out + k, b + j, sizeof(T) * (nb - j));
+        k += nb - j;
+    }
+    return k;
+}
+
+/**
+ * Difference of two sorted sets, elements of a not in b.
+ * @param out: Holds at least na elements, must not overlap a or b.
+ * @return The number of elements written.
+ */
+template <typename T>
+static int64_t difference_sorted(const T* a, int64_t na, const T* b, int64_t nb, T* out) {
+    if (na <= 0) {
+        return 0;
+    }
+    if (nb <= 0) {
+        memmove(out, a, sizeof(T) * na);
+        return na;
+    }
+    int64_t k = 0;
+    if (nb / na >= SETOP_GALLOP_RATIO) {
+        // Search every element of a in b.
+        int64_t pos = 0;
+        for (int64_t i = 0; i < na; ++i) {
+            pos = _setop_gallop(b, pos, nb, a[i]);
+            if (pos == nb || b[pos] != a[i]) {
+                out[k++] = a[i];
+            }
+        }
+        return k;
+    }
+    if (na / nb >= SETOP_GALLOP_RATIO) {
+        // Copy the ranges of a between elements of b.
+        int64_t pos = 0;
+        for (int64_t j = 0; j < nb && pos < na; ++j) {
+            int64_t found = _setop_gallop(a, pos, na, b[j]);
+            memmove(out + k, a + pos, sizeof(T) * (found - pos));
+            k += found - pos;
+            pos = (found < na && a[found] == b[j]) ? found + 1 : found;
+        }
+        memmove(out + k, a + pos, sizeof(T) * (na - pos));
+        return k + na - pos;
+    }
+    return _difference_block(a, na, b, nb, out);
+}
+
+/**
+ * Intersection of k sorted sets, from the smallest set to the biggest.
+ * @param out: Holds at least the smallest length elements.
+ * @return The number of elements written.
+ */
+template <typename T>
+static int64_t intersect_sorted(const T* const* seqs, const int64_t* lengths, int64_t k, T* out) {
+    if (k <= 0) {
+        return 0;
+    }
+    vector<int64_t> order(k);
+    for (int64_t i = 0; i < k; ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [lengths](int64_t l, int64_t r) {
+        return lengths[l] < lengths[r];
+    });
+    if (k == 1) {
+        memmove(out, seqs[order[0]], sizeof(T) * lengths[order[0]]);
+        return lengths[order[0]];
+    }
+    int64_t count = intersect_sorted(seqs[order[0]], lengths[order[0]],
+                                     seqs[order[1]], lengths[order[1]], out);
+    vector<T> tmp(count);
+    for (int64_t i = 2; i < k && count > 0; ++i) {
+        memcpy(tmp.data(), out, sizeof(T) * count);
+        count = intersect_sorted((const T*)tmp.data(), count, seqs[order[i]], lengths[order[i]], out);
+    }
+    return count;
+}
+
+} // End namespace wttool.
+
+#endif // End ifdef __WTTOOL_SETOP_HPP_.
@@ -9,9 +9,14 @@
 
 #include <vector>
 #include <iostream>
+#include <algorithm>
+#include <new>
+#include <unordered_map>
+#include <utility>
 
 #include "compare.hpp"
 #include "systool.hpp"
+#include "sortstat.hpp"
 
 namespace wttool {
 
@@ -30,11 +35,13 @@ static int qsort(vector<T>* data,
                  int (*compare)(const T& lhs, const T& rhs) = cmp<T>, 
                  int64_t s = 0,
                  int64_t e = 0) {
+    SORT_STAT_CALL(T, compare);
     if (length == 0 || length == 1) {
         return 0;
     }
     if (length == 2 && compare(data[s], data[e]) > 0) {
         std::swap(data[s], data[e]);
+        SORT_STAT_MOVE(3);
         return 0;
     }
     int64_t head = s;
@@ -44,22 +51,28 @@ static int qsort(vector<T>* data,
         s = head = 0;
         e = tail = length - 1;
     }
-    T pivot = data[e];
-    while (tail > head) {
-        while (tail > head && compare(data[head], pivot) <= 0) {
-            ++head;
-        }
-        if (tail > head) {
-            data[tail] = data[head];
-        }
-        while (tail > head && compare(data[tail], pivot) >= 0) {
-            --tail;
-        }
-        if (tail > head) {
-            data[head] = data[tail];
+    {
+        SORT_STAT_PHASE(SORT_PHASE_PARTITION);
+        T pivot = data[e];
+        while (tail > head) {
+            while (tail > head && compare(data[head], pivot) <= 0) {
+                ++head;
+            }
+            if (tail > head) {
+                data[tail] = data[head];
+                SORT_STAT_MOVE(1);
+            }
+            while (tail > head && compare(data[tail], pivot) >= 0) {
+                --tail;
+            }
+            if (tail > head) {
+                data[head] = data[tail];
+                SORT_STAT_MOVE(1);
+            }
         }
+        data[tail] = pivot;
+        SORT_STAT_MOVE(2);
     }
-    data[tail] = pivot;
     qsort(data, tail - s, compare, s, tail - 1);
     qsort(data, e - tail, compare, tail + 1, e);
     return 0;
@@ -78,11 +91,13 @@ static int qsort(T* data,
                  int (*compare)(const T& lhs, const T& rhs) = cmp<T>, 
                  int64_t s = 0, 
                  int64_t e = 0) {
+    SORT_STAT_CALL(T, compare);
     if (length == 0 || length == 1) {
         return 0;
     }
     if (length == 2 && compare(data[s], data[e]) > 0) {
         std::swap(data[s], data[e]);
+        SORT_STAT_MOVE(3);
         return 0;
     }
     int64_t head = s;
@@ -92,22 +107,28 @@ static int qsort(T* data,
         s = head = 0;
         e = tail = length - 1;
     }
-    T pivot = data[e];
-    while (tail > head) {
-        while (tail > head && compare(data[head], pivot) <= 0) {
-            ++head;
-        }
-        if (tail > head) {
-            data[tail] = data[head];
-        }
-        while (tail > head && compare(data[tail], pivot) >= 0) {
-            --tail;
-        }
-        if (tail > head) {
-            data[head] = data[tail];
+    {
+        SORT_STAT_PHASE(SORT_PHASE_PARTITION);
+        T pivot = data[e];
+        while (tail > head) {
+            while (tail > head && compare(data[head], pivot) <= 0) {
+                ++head;
+            }
+            if (tail > head) {
+                data[tail] = data[head];
+                SORT_STAT_MOVE(1);
+            }
+            while (tail > head && compare(data[tail], pivot) >= 0) {
+                --tail;
+            }
+            if (tail > head) {
+                data[head] = data[tail];
+                SORT_STAT_MOVE(1);
+            }
         }
+        data[tail] = pivot;
+        SORT_STAT_MOVE(2);
     }
-    data[tail] = pivot;
     qsort(data, tail - s, compare, s, tail - 1);
     qsort(data, e - tail, compare, tail + 1, e);
     return 0;
@@ -123,6 +144,7 @@ template <typename T>
 static int isort(T* data, 
                  int64_t length,
                  int (*compare)(const T& lhs, const T& rhs) = cmp<T>) {
+    SORT_STAT_CALL(T, compare);
     if (length == 1 || length == 0) {
         return 0;
     }
@@ -131,7 +153,7 @@ static int isort(T* data,
         T cur_data = data[i];
         int64_t j = i - 1;
         for (; j >= 0; --j) {
-            if (cmp(data[j], cur_data) > 0) {
+            if (compare(data[j], cur_data) > 0) {
                 continue;
             }
             break;
@@ -143,6 +165,7 @@ static int isort(T* data,
             data[k + 1] = data[k];
         }
         data[j + 1] = cur_data;
+        SORT_STAT_MOVE(i - j + 1);
     }
     return 0;
 }
@@ -164,10 +187,12 @@ static void _ssort_once(T* data,
     for (int64_t i = begin + gap; i < length; i = i + gap) {
         T cur_data = data[i];
         int64_t j = i - gap;
-        for (; j >= 0 && data[j] > cur_data; j = j - gap) {
+        for (; j >= 0 && compare(data[j], cur_data) > 0; j = j - gap) {
             data[j + gap] = data[j];
+            SORT_STAT_MOVE(1);
         }
         data[j + gap] = cur_data;
+        SORT_STAT_MOVE(2);
     }
 }
 
@@ -181,6 +206,7 @@ template <typename T>
 static int ssort(T* data, 
                  int64_t length,
                  int (*compare)(const T& lhs, const T& rhs) = cmp<T>) {
+    SORT_STAT_CALL(T, compare);
     if (length == 0 || length == 1) {
         return 0;
     } 
@@ -188,7 +214,7 @@ static int ssort(T* data,
     while (gap > 0) {
         int64_t begin = gap - 1;
         while (begin >= 0) {
-            _ssort_once(data, length, cmp, begin, gap);
+            _ssort_once(data, length, compare, begin, gap);
             begin--;
         }
         gap /= 2;
@@ -206,6 +232,7 @@ template <typename T>
 static int sel_sort(T* data, 
                  int64_t length,
                  int (*compare)(const T& lhs, const T& rhs) = cmp<T>) {
+    SORT_STAT_CALL(T, compare);
     for (int64_t i = 0; i < length; ++i) {
         int64_t min_pos = i;
         for (int64_t j = i + 1; j < length; ++j) {
@@ -214,6 +241,7 @@ static int sel_sort(T* data,
             }
         }
         std::swap(data[min_pos], data[i]);
+        SORT_STAT_MOVE(3);
     }
     return 0;
 }
@@ -231,6 +259,7 @@ static int msort(T* data,
                  int (*compare)(const T& lhs, const T& rhs) = cmp<T>,
                  int64_t s = 0,
                  int64_t e = 0) {
+    SORT_STAT_CALL(T, compare);
     if (s == 0 && e == 0) {
         // The first loop.
         e = length - 1;
@@ -241,18 +270,22 @@ static int msort(T* data,
     if (length == 2) {
         if (compare(data[s], data[e]) > 0) {
             std::swap(data[s], data[e]);
+            SORT_STAT_MOVE(3);
         }
         return 0;
     }
-    int64_t middle = length / 2;
-    msort(data, length - middle, compare, s, s + middle);
-    msort(data, middle, compare, s + middle + 1, e);
+    // The first half is [s, s + middle], the second half is [s + middle + 1, e].
+    int64_t middle = (length - 1) / 2;
+    msort(data, middle + 1, compare, s, s + middle);
+    msort(data, length - middle - 1, compare, s + middle + 1, e);
+    SORT_STAT_PHASE(SORT_PHASE_MERGE);
     int64_t f_pos = s;
     int64_t s_pos = s + middle + 1;
     int64_t t_pos = 0;
     T* tmp = new T[length];
+    SORT_STAT_ALLOC(sizeof(T) * length);
     while (f_pos <= s + middle && s_pos <= e) {
-        if (data[f_pos] > data[s_pos]) {
+        if (compare(data[f_pos], data[s_pos]) > 0) {
             tmp[t_pos++] = data[s_pos++];
         } else {
             tmp[t_pos++] = data[f_pos++];
@@ -269,10 +302,359 @@ static int msort(T* data,
         data[s + i] = tmp[i];
     }
     delete[] tmp;
+    SORT_STAT_MOVE(2 * length);
+    return 0;
+}
+
+/**
+ * The assist functions for Adaptive Sort.
+ * Do not use outside.
+ */
+#define TSORT_MIN_RUN 32
+#define TSORT_MIN_GALLOP 7
+
+/**
+ * Find the boundary k in a[0, n), where a[i] < key for i < k and a[i] >= key
+ * for i >= k. If right is true, use a[i] <= key instead of a[i] < key.
+ * Search exponentially from the head, or from the tail if from_end is true.
+ */
+template <typename T>
+static int64_t _tsort_gallop(const T& key,
+                             const T* a,
+                             int64_t n,
+                             bool right,
+                             bool from_end,
+                             int (*compare)(const T& lhs, const T& rhs)) {
+    int64_t lo = 0;
+    int64_t hi = n;
+    int64_t step = 1;
+    if (!from_end) {
+        int64_t i = 0;
+        while (i < n) {
+            int res = compare(a[i], key);
+            if (res > 0 || (res == 0 && !right)) {
+                break;
+            }
+            lo = i + 1;
+            i += step;
+            step *= 2;
+        }
+        hi = (i < n) ? i : n;
+    } else {
+        int64_t i = n - 1;
+        while (i >= 0) {
+            int res = compare(a[i], key);
+            if (res < 0 || (res == 0 && right)) {
+                break;
+            }
+            hi = i;
+            i -= step;
+            step *= 2;
+        }
+        lo = (i >= 0) ? i + 1 : 0;
+    }
+    while (lo < hi) {
+        int64_t mid = lo + (hi - lo) / 2;
+        int res = compare(a[mid], key);
+        if (res < 0 || (res == 0 && right)) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/**
+ * Find the natural run beginning at s, reverse it if it is strictly descending,
+ * extend it to TSORT_MIN_RUN elements by binary insertion.
+ * @return The end of the run.
+ */
+template <typename T>
+static int64_t _tsort_next_run(T* data,
+                               int64_t s,
+                               int64_t length,
+                               int (*compare)(const T& lhs, const T& rhs)) {
+    SORT_STAT_PHASE(SORT_PHASE_RUN);
+    int64_t e = s + 1;
+    if (e >= length) {
+        return length;
+    }
+    if (compare(data[e], data[s]) < 0) {
+        // Strictly descending, so reversing keeps the sort stable.
+        while (e + 1 < length && compare(data[e + 1], data[e]) < 0) {
+            ++e;
+        }
+        ++e;
+        std::reverse(data + s, data + e);
+        SORT_STAT_MOVE(e - s);
+    } else {
+        while (e + 1 < length && compare(data[e + 1], data[e]) >= 0) {
+            ++e;
+        }
+        ++e;
+    }
+    int64_t forced = (length - s < TSORT_MIN_RUN) ? length : s + TSORT_MIN_RUN;
+    for (; e < forced; ++e) {
+        T cur_data = std::move(data[e]);
+        int64_t pos = s + _tsort_gallop(cur_data, data + s, e - s, true, true, compare);
+        std::move_backward(data + pos, data + e, data + e + 1);
+        data[pos] = std::move(cur_data);
+        SORT_STAT_MOVE(e - pos + 2);
+    }
+    return e;
+}
+
+/**
+ * Merge [s, m) and [m, e) when the first run is shorter, the first run is moved
+ * to buf and merged forward.
+ */
+template <typename T>
+static void _tsort_merge_lo(T* data,
+                            int64_t s,
+                            int64_t m,
+                            int64_t e,
+                            T* buf,
+                            int64_t* min_gallop,
+                            int (*compare)(const T& lhs, const T& rhs)) {
+    int64_t na = m - s;
+    std::move(data + s, data + m, buf);
+    int64_t i = 0;
+    int64_t j = m;
+    int64_t k = s;
+    while (i < na && j < e) {
+        int64_t a_wins = 0;
+        int64_t b_wins = 0;
+        while (i < na && j < e) {
+            if (compare(data[j], buf[i]) < 0) {
+                data[k++] = std::move(data[j++]);
+                a_wins = 0;
+                if (++b_wins >= *min_gallop) {
+                    break;
+                }
+            } else {
+                data[k++] = std::move(buf[i++]);
+                b_wins = 0;
+                if (++a_wins >= *min_gallop) {
+                    break;
+                }
+            }
+        }
+        // Galloping mode, move blocks found by exponential search.
+        while (i < na && j < e) {
+            int64_t a_count = _tsort_gallop(data[j], buf + i, na - i, true, false, compare);
+            std::move(buf + i, buf + i + a_count, data + k);
+            i += a_count;
+            k += a_count;
+            if (i == na) {
+                break;
+            }
+            data[k++] = std::move(data[j++]);
+            if (j == e) {
+                break;
+            }
+            int64_t b_count = _tsort_gallop(buf[i], data + j, e - j, false, false, compare);
+            std::move(data + j, data + j + b_count, data + k);
+            j += b_count;
+            k += b_count;
+            if (j == e) {
+                break;
+            }
+            data[k++] = std::move(buf[i++]);
+            if (a_count < TSORT_MIN_GALLOP && b_count < TSORT_MIN_GALLOP) {
+                ++*min_gallop;
+                break;
+            }
+            if (*min_gallop > 1) {
+                --*min_gallop;
+            }
+        }
+    }
+    std::move(buf + i, buf + na, data + k);
+    SORT_STAT_MOVE(na + e - s);
+}
+
+/**
+ * Merge [s, m) and [m, e) when the second run is shorter, the second run is moved
+ * to buf and merged backward.
+ */
+template <typename T>
+static void _tsort_merge_hi(T* data,
+                            int64_t s,
+                            int64_t m,
+                            int64_t e,
+                            T* buf,
+                            int64_t* min_gallop,
+                            int (*compare)(const T& lhs, const T& rhs)) {
+    int64_t nb = e - m;
+    std::move(data + m, data + e, buf);
+    int64_t i = m - 1;
+    int64_t j = nb - 1;
+    int64_t k = e - 1;
+    while (i >= s && j >= 0) {
+        int64_t a_wins = 0;
+        int64_t b_wins = 0;
+        while (i >= s && j >= 0) {
+            if (compare(buf[j], data[i]) < 0) {
+                data[k--] = std::move(data[i--]);
+                b_wins = 0;
+                if (++a_wins >= *min_gallop) {
+                    break;
+                }
+            } else {
+                data[k--] = std::move(buf[j--]);
+                a_wins = 0;
+                if (++b_wins >= *min_gallop) {
+                    break;
+                }
+            }
+        }
+        // Galloping mode, move blocks found by exponential search from the tail.
+        while (i >= s && j >= 0) {
+            int64_t a_count = i - s + 1 -
+                _tsort_gallop(buf[j], data + s, i - s + 1, true, true, compare);
+            std::move_backward(data + i - a_count + 1, data + i + 1, data + k + 1);
+            i -= a_count;
+            k -= a_count;
+            if (i < s) {
+                break;
+            }
+            data[k--] = std::move(buf[j--]);
+            if (j < 0) {
+                break;
+            }
+            int64_t b_count = j + 1 - _tsort_gallop(data[i], buf, j + 1, false, true, compare);
+            std::move_backward(buf + j - b_count + 1, buf + j + 1, data + k + 1);
+            j -= b_count;
+            k -= b_count;
+            if (j < 0) {
+                break;
+            }
+            data[k--] = std::move(data[i--]);
+            if (a_count < TSORT_MIN_GALLOP && b_count < TSORT_MIN_GALLOP) {
+                ++*min_gallop;
+                break;
+            }
+            if (*min_gallop > 1) {
+                --*min_gallop;
+            }
+        }
+    }
+    std::move(buf, buf + j + 1, data + s);
+    SORT_STAT_MOVE(nb + e - s);
+}
+
+/**
+ * Merge the adjacent sorted runs [s, m) and [m, e).
+ */
+template <typename T>
+static void _tsort_merge(T* data,
+                         int64_t s,
+                         int64_t m,
+                         int64_t e,
+                         T* buf,
+                         int64_t* min_gallop,
+                         int (*compare)(const T& lhs, const T& rhs)) {
+    SORT_STAT_PHASE(SORT_PHASE_MERGE);
+    // Elements of the first run not bigger than the second run's head are in place.
+    s += _tsort_gallop(data[m], data + s, m - s, true, false, compare);
+    if (s == m) {
+        return;
+    }
+    // Elements of the second run not smaller than the first run's tail are in place.
+    e = m + _tsort_gallop(data[m - 1], data + m, e - m, false, true, compare);
+    if (e == m) {
+        return;
+    }
+    if (m - s <= e - m) {
+        _tsort_merge_lo(data, s, m, e, buf, min_gallop, compare);
+    } else {
+        _tsort_merge_hi(data, s, m, e, buf, min_gallop, compare);
+    }
+}
+
+/**
+ * The powersort merge priority of the boundary between
+ * run [s1, s1 + n1) and run [s1 + n1, s1 + n1 + n2).
+ */
+static int _tsort_node_power(int64_t s1, int64_t n1, int64_t n2, int64_t length) {
+    // Compare the doubled middle points of both runs as binary fractions of 2 * length.
+    int64_t a = 2 * s1 + n1;
+    int64_t b = a + n1 + n2;
+    int power = 0;
+    while (true) {
+        ++power;
+        if (a >= length) {
+            a -= length;
+            b -= length;
+        } else if (b >= length) {
+            break;
+        }
+        a <<= 1;
+        b <<= 1;
+    }
+    return power;
+}
+
+/**
+ * Adaptive Sort, stable.
+ * Natural runs are detected and merged by the powersort policy with galloping,
+ * sorted or reversed input costs a single pass.
+ * @param data: The array need be sorted.
+ * @param length: Sort the head N elements, it should not be bigger than the array length.
+ * @param compare: The function to compare the elements.
+ */
+template <typename T>
+static int tsort(T* data,
+                 int64_t length,
+                 int (*compare)(const T& lhs, const T& rhs) = cmp<T>) {
+    SORT_STAT_CALL(T, compare);
+    if (length == 0 || length == 1) {
+        return 0;
+    }
+    struct Run {
+        int64_t start;
+        int64_t end;
+        int     power;
+    };
+    vector<Run> runs;
+    T* buf = nullptr;
+    int64_t min_gallop = TSORT_MIN_GALLOP;
+    int64_t s1 = 0;
+    int64_t e1 = _tsort_next_run(data, 0, length, compare);
+    while (e1 < length) {
+        int64_t e2 = _tsort_next_run(data, e1, length, compare);
+        int power = _tsort_node_power(s1, e1 - s1, e2 - e1, length);
+        while (!runs.empty() && runs.back().power > power) {
+            if (buf == nullptr) {
+                buf = new T[length / 2 + 1];
+                SORT_STAT_ALLOC(sizeof(T) * (length / 2 + 1));
+            }
+            _tsort_merge(data, runs.back().start, s1, e1, buf, &min_gallop, compare);
+            s1 = runs.back().start;
+            runs.pop_back();
+        }
+        Run run = {s1, e1, power};
+        runs.push_back(run);
+        SORT_STAT_DEPTH(runs.size());
+        s1 = e1;
+        e1 = e2;
+    }
+    while (!runs.empty()) {
+        if (buf == nullptr) {
+            buf = new T[length / 2 + 1];
+            SORT_STAT_ALLOC(sizeof(T) * (length / 2 + 1));
+        }
+        _tsort_merge(data, runs.back().start, s1, e1, buf, &min_gallop, compare);
+        s1 = runs.back().start;
+        runs.pop_back();
+    }
+    delete[] buf;
     return 0;
 }
 
-// Heap supporting search remove and find, do not finish.
+// Heap supporting search remove and find.
+// Keys are unique, K must be hashable by std::hash.
 template <typename K, typename V>
 class Heap {
 private:
@@ -293,7 +675,7 @@ public:
     
     /**
      * Push element to the heap.
-     * @return 0 means successfully.
+     * @return 0 means successfully, -1 means the key exists or expanding failed.
      */
     int push(const K& key, const V& val);
     
@@ -345,41 +727,54 @@ private:
      * Find the position of node which holding the key.
      * @return -1 means unexisting.
      */
-    int64_t _find_node(const T& key);
+    int64_t _find_node(const K& key);
     
     /**
      * Adjust the element at place pos.
      */
     void _adjust(int64_t pos);
-}; 
 
-} // End namespace wttool.
+    /**
+     * If the node at lhs should be above the node at rhs.
+     */
+    bool _above(int64_t lhs, int64_t rhs);
+
+    /**
+     * Swap two nodes and their positions.
+     */
+    void _swap(int64_t lhs, int64_t rhs);
+}; 
 
 template <typename K, typename V>
 Heap<K, V>::Heap(bool min, int (*compare)(const K& lhs, const K& rhs), int64_t reserved) :
-    _length(0), _capacity(reserved), _min_heap(min), _compare(compare) {
-    _data = new(std::nothrow) T[_capacity];
+    _length(0), _capacity(reserved > 0 ? reserved : 1), _min_heap(min), _compare(compare) {
+    _data = new(std::nothrow) Node<K, V>[_capacity];
     if (_data == nullptr) {
         toscreen << "Having problem when initializing the heap: malloc memory failed.\n";
         _capacity = 0;
     }
 }
 
+template <typename K, typename V>
+Heap<K, V>::~Heap() {
+    delete[] _data;
+}
+
 template <typename K, typename V>
 int Heap<K, V>::push(const K& key, const V& val) {
+    if (_find_node(key) != -1) {
+        // Existing key.
+        return -1;
+    }
     if (_capacity <= _length) {
         if (_expand() != 0) {
             toscreen << "Expand the heap failed. Insert element failed.\n";
             return -1;
         }
-    }
-    int64_t pos = _find_node(key);
-    if (pos == -1) {
-        
     }
     _data[_length].key = key;
     _data[_length].val = val;
-    _pos[key] = 
+    _pos[key] = _length;
     _adjust(_length++);
     return 0;
 }
@@ -408,11 +803,11 @@ int Heap<K, V>::erase(const K& key, V* val) {
         *val = _data[pos].val;
     }
     --_length;
-    if (_length == 0) {
-        return 0;
+    if (pos != _length) {
+        _swap(pos, _length);
     }
-    std::swap(_data[_length], _data[pos]);
-    if (_length != 1) {
+    _pos.erase(key);
+    if (pos < _length) {
         _adjust(pos);
     }
     return 0;
@@ -437,12 +832,8 @@ int Heap<K, V>::pop() {
     if (_length == 0) {
         return -1;
     }
-    if (_length == 1) {
-        _length = 0;
-    }
-    std::swap(_data[--_length], _data[0]);
-    _adjust(0);
-    return 0;
+    K key = _data[0].key;
+    return erase(key);
 }
 
 template <typename K, typename V>
@@ -452,7 +843,8 @@ int64_t Heap<K, V>::size() {
 
 template <typename K, typename V>
 int Heap<K, V>::_expand() {
-    Node<K, V>* _new_data = new(std::nothrow) Node<K, V>[_capacity * 2];
+    int64_t capacity = (_capacity > 0) ? _capacity * 2 : 1;
+    Node<K, V>* _new_data = new(std::nothrow) Node<K, V>[capacity];
     if (_new_data == nullptr) {
         return -1;
     }
@@ -463,25 +855,58 @@ int Heap<K, V>::_expand() {
     }
     delete[] _data;
     _data = _new_data;
-    _capacity *= 2;
+    _capacity = capacity;
     return 0;
 }
 
 template <typename K, typename V>
-int64_t Heap<K, V>::_find_node(const T& key) {
-    if (_length == 0) {
+int64_t Heap<K, V>::_find_node(const K& key) {
+    auto it = _pos.find(key);
+    if (it == _pos.end()) {
         return -1;
     }
-    int64_t cur_pos = 0;
-    while (cur_pos < _length) {
-        int cmp_res = _compare(_data[cur_pos].key, key);
-        if (cmp_res == 0) {
-            return cur_pos;
+    return it->second;
+}
+
+template <typename K, typename V>
+bool Heap<K, V>::_above(int64_t lhs, int64_t rhs) {
+    int res = _compare(_data[lhs].key, _data[rhs].key);
+    return _min_heap ? (res < 0) : (res > 0);
+}
+
+template <typename K, typename V>
+void Heap<K, V>::_swap(int64_t lhs, int64_t rhs) {
+    std::swap(_data[lhs], _data[rhs]);
+    _pos[_data[lhs].key] = lhs;
+    _pos[_data[rhs].key] = rhs;
+}
+
+template <typename K, typename V>
+void Heap<K, V>::_adjust(int64_t pos) {
+    // Sift up.
+    while (pos > 0 && _above(pos, (pos - 1) / 2)) {
+        _swap(pos, (pos - 1) / 2);
+        pos = (pos - 1) / 2;
+    }
+    // Sift down.
+    while (true) {
+        int64_t best = pos;
+        int64_t left = pos * 2 + 1;
+        int64_t right = pos * 2 + 2;
+        if (left < _length && _above(left, best)) {
+            best = left;
         }
-        if (cmp_res > 0 && ) {
-            
+        if (right < _length && _above(right, best)) {
+            best = right;
         }
+        if (best == pos) {
+            break;
+        }
+        _swap(pos, best);
+        pos = best;
     }
 }
 
+} // End namespace wttool.
+
 #endif // End ifdef __WTTOOL_SORT_HPP_.
@@ -0,0 +1,1027 @@
+/**
+ * Local sort/merge service over a Unix domain socket.
+ * A client streams record batches, the server sorts every batch by tsort on
+ * a worker pool as soon as it arrives, and when the client ends the job the
+ * sorted batches are merged by a loser tree and streamed back.
+ * Records are compared as bytes by memcmp, a shorter prefix goes first.
+ *
+ * Wire format, every frame is a SortFrameHeader followed by length bytes:
+ *     SORT_FRAME_BEGIN:    optional first frame of a job, the payload is two
+ *                          uint64_t, the length of all the batches and the
+ *                          number of records. The memory of the whole job is
+ *                          reserved before any batch is read.
+ *     SORT_FRAME_BATCH:    count records, each is [uint32_t size][size bytes].
+ *     SORT_FRAME_BATCH_FD: no payload, the records are in a memfd passed by
+ *                          SCM_RIGHTS, the first length bytes are used. The
+ *                          memfd must be sealed against shrinking and writing.
+ *     SORT_FRAME_END:      no payload. From the client it ends the job, from
+ *                          the server it ends the sorted output.
+ *     SORT_FRAME_ERROR:    the payload is the message, the connection is closed.
+ * The server answers a job by SORT_FRAME_BATCH frames and a SORT_FRAME_END,
+ * then the connection may run the next job. Integers are in host byte order.
+ *
+ * Received batches are sorted in place, the output is sent by sendmsg with
+ * iovecs pointing into the received buffers, so records are never copied in
+ * user space. Buffered bytes of all connections are limited, a batch waits
+ * for memory before being read, so a fast client is slowed down by the socket.
+ * A declared job waits for its whole size once, in the order of arriving, and
+ * never waits while holding memory. A job not declared takes memory batch by
+ * batch, it fails at once if it has to wait while every job holding memory
+ * waits too, since none of them would release it.
+ * E.g.,
+ *     SortServer server(4, 1 << 30);
+ *     server.start("/tmp/sort.sock");
+ *     ...
+ *     SortClient client;
+ *     client.connect("/tmp/sort.sock");
+ *     client.begin(bytes, records);
+ *     client.send_batch(records_1);
+ *     client.send_batch(records_2);
+ *     client.finish();
+ *     StrView record;
+ *     while (client.next(&record) == 0) { ... }
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_SORTSERVER_HPP_
+#define __WTTOOL_SORTSERVER_HPP_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "systool.hpp"
+#include "stloperation.hpp"
+#include "sort.hpp"
+#include "merge.hpp"
+
+#define SORTSERVER_MEMORY_LIMIT ((size_t)1 << 30)
+#define SORTSERVER_WAIT_MS 10000
+// Records per output frame.
+#define SORTSERVER_FRAME_RECORDS 500
+// Iovecs per sendmsg, not over IOV_MAX.
+#define SORTSERVER_IOV_MAX 1024
+// Seals a passed memfd must have, so it can not be truncated under the mapping.
+#define SORTSERVER_MEMFD_SEALS (F_SEAL_SHRINK | F_SEAL_WRITE)
+
+namespace wttool {
+
+using namespace std;
+
+enum SortFrameType {
+    SORT_FRAME_BATCH = 1,
+    SORT_FRAME_BATCH_FD,
+    SORT_FRAME_END,
+    SORT_FRAME_ERROR,
+    SORT_FRAME_BEGIN
+};
+
+struct SortFrameHeader {
+    uint32_t type;
+    uint32_t count;
+    uint64_t length;
+};
+
+/**
+ * Byte order of records, a shorter prefix goes first.
+ */
+static int _sort_record_cmp(const StrView& lhs, const StrView& rhs) {
+    size_t size = (lhs.size < rhs.size) ? lhs.size : rhs.size;
+    int res = (size == 0) ? 0 : memcmp(lhs.data, rhs.data, size);
+    if (res != 0) {
+        return (res < 0) ? -1 : 1;
+    }
+    if (lhs.size == rhs.size) {
+        return 0;
+    }
+    return (lhs.size < rhs.size) ? -1 : 1;
+}
+
+/**
+ * Send all the iovecs, the iovecs are modified.
+ * @param pass_fd: If not -1, passed by SCM_RIGHTS with the first byte.
+ * @return 0 means successfully.
+ */
+static int _sortserver_send(int fd, struct iovec* iov, size_t count, int pass_fd = -1) {
+    char control[CMSG_SPACE(sizeof(int))];
+    while (count > 0) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (count < SORTSERVER_IOV_MAX) ? count : SORTSERVER_IOV_MAX;
+        if (pass_fd != -1) {
+            memset(control, 0, sizeof(control));
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(cmsg), &pass_fd, sizeof(int));
+        }
+        ssize_t sent = sendmsg(fd, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        pass_fd = -1;
+        // Skip the sent bytes.
+        while (count > 0 && (size_t)sent >= iov->iov_len) {
+            sent -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + sent;
+            iov->iov_len -= sent;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Receive exactly length bytes.
+ * @param passed_fd: If not nullptr, gets the fd passed by SCM_RIGHTS, or keeps -1.
+ * @return 0 means successfully, 1 means the peer closed before the first byte.
+ */
+static int _sortserver_recv(int fd, void* buf, size_t length, int* passed_fd = nullptr) {
+    char control[CMSG_SPACE(sizeof(int))];
+    size_t got = 0;
+    while (got < length) {
+        struct iovec iov;
+        iov.iov_base = (char*)buf + got;
+        iov.iov_len = length - got;
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        if (passed_fd != nullptr) {
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+        }
+        ssize_t res = recvmsg(fd, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC);
+        if (res < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        if (res == 0) {
+            return (got == 0) ? 1 : -1;
+        }
+        if (passed_fd != nullptr) {
+            for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                    int pass_fd = -1;
+                    memcpy(&pass_fd, CMSG_DATA(cmsg), sizeof(int));
+                    if (*passed_fd != -1) {
+                        close(*passed_fd);
+                    }
+                    *passed_fd = pass_fd;
+                }
+            }
+        }
+        got += res;
+    }
+    return 0;
+}
+
+/**
+ * Parse count records of [uint32_t size][size bytes], the views point into data.
+ * @return 0 means the records fill the data exactly.
+ */
+static int _sortserver_parse(const char* data, size_t length, uint32_t count, vector<StrView>* records) {
+    records->clear();
+    records->reserve(count);
+    size_t pos = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t size = 0;
+        if (length - pos < sizeof(size)) {
+            return -1;
+        }
+        memcpy(&size, data + pos, sizeof(size));
+        pos += sizeof(size);
+        if (length - pos < size) {
+            return -1;
+        }
+        records->push_back(StrView(data + pos, size));
+        pos += size;
+    }
+    return (pos == length) ? 0 : -1;
+}
+
+/**
+ * Fixed number of threads running tasks in the order of submitting.
+ */
+class SortWorkerPool {
+public:
+    SortWorkerPool(int threads) : _stopping(false) {
+        for (int i = 0; i < ((threads > 0) ? threads : 1); ++i) {
+            _threads.push_back(std::thread(&SortWorkerPool::_run, this));
+        }
+    }
+
+    /**
+     * Run the tasks left, then join the threads.
+     */
+    virtual ~SortWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _cond.notify_all();
+        for (size_t i = 0; i < _threads.size(); ++i) {
+            _threads[i].join();
+        }
+    }
+
+    void submit(const std::function<void()>& task) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tasks.push(task);
+        }
+        _cond.notify_one();
+    }
+
+private:
+    std::mutex                          _mutex;
+    std::condition_variable             _cond;
+    std::queue<std::function<void()> >  _tasks;
+    vector<std::thread>                 _threads;
+    bool                                _stopping;
+
+    SortWorkerPool(const SortWorkerPool&);
+    SortWorkerPool& operator=(const SortWorkerPool&);
+
+    void _run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _cond.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+                if (_tasks.empty()) {
+                    return;
+                }
+                task = std::move(_tasks.front());
+                _tasks.pop();
+            }
+            task();
+        }
+    }
+};
+
+class SortServer {
+public:
+    /**
+     * @param workers: The number of sorting threads.
+     * @param memory_limit: The bytes of batches buffered by all connections.
+     * @param wait_ms: How long a batch waits for memory before the job fails.
+     */
+    SortServer(int workers = 4, size_t memory_limit = SORTSERVER_MEMORY_LIMIT,
+               int64_t wait_ms = SORTSERVER_WAIT_MS) :
+        _pool(workers), _memory_limit(memory_limit), _memory_used(0), _wait_ms(wait_ms),
+        _memory_ticket(0), _holders(0), _waiting_holders(0),
+        _listen_fd(-1), _running(false), _stopping(false) {}
+
+    virtual ~SortServer() {
+        stop();
+    }
+
+    /**
+     * Listen on the path and serve every connection by a thread.
+     * An existing file of the path is removed.
+     * @return 0 means successfully.
+     */
+    int start(const string& path) {
+        struct sockaddr_un addr;
+        if (_running || path.size() >= sizeof(addr.sun_path)) {
+            toscreen << "Start sort server failed, running or the path is too long.\n";
+            return -1;
+        }
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.data(), path.size());
+        _listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (_listen_fd < 0) {
+            toscreen << "Create socket failed: " << strerror(errno) << ".\n";
+            return -1;
+        }
+        unlink(path.c_str());
+        if (bind(_listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(_listen_fd, 128) != 0) {
+            toscreen << "Listen on " << path << " failed: " << strerror(errno) << ".\n";
+            close(_listen_fd);
+            _listen_fd = -1;
+            return -1;
+        }
+        _path = path;
+        _stopping = false;
+        _running = true;
+        _acceptor = std::thread(&SortServer::_accept_loop, this);
+        return 0;
+    }
+
+    /**
+     * Stop listening, close all connections and wait for their threads.
+     */
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(_conn_mutex);
+            _stopping = true;
+            for (set<int>::iterator it = _conns.begin(); it != _conns.end(); ++it) {
+                shutdown(*it, SHUT_RDWR);
+            }
+        }
+        {
+            // Taken so a connection checking the budget can not miss the wakeup.
+            std::lock_guard<std::mutex> lock(_memory_mutex);
+        }
+        _memory_cond.notify_all();
+        if (_running) {
+            shutdown(_listen_fd, SHUT_RDWR);
+            _acceptor.join();
+            close(_listen_fd);
+            _listen_fd = -1;
+            unlink(_path.c_str());
+            _running = false;
+        }
+        std::unique_lock<std::mutex> lock(_conn_mutex);
+        _conn_cond.wait(lock, [this]() { return _conns.empty(); });
+    }
+
+    /**
+     * Serve a connected socket until the peer closes it, e.g., one end of a
+     * socketpair. The fd is closed at the end.
+     * @return 0 means the peer closed normally.
+     */
+    int serve_fd(int fd) {
+        {
+            std::lock_guard<std::mutex> lock(_conn_mutex);
+            if (_stopping) {
+                close(fd);
+                return -1;
+            }
+            _conns.insert(fd);
+        }
+        _Job job;
+        int res = 0;
+        while (true) {
+            SortFrameHeader header;
+            int passed_fd = -1;
+            res = _sortserver_recv(fd, &header, sizeof(header), &passed_fd);
+            if (res != 0) {
+                res = (res == 1 && job.batches.empty()) ? 0 : -1;
+                break;
+            }
+            // Only SORT_FRAME_BATCH_FD carries an fd, any other one is dropped.
+            if (header.type != SORT_FRAME_BATCH_FD && passed_fd != -1) {
+                close(passed_fd);
+                passed_fd = -1;
+            }
+            if (header.type == SORT_FRAME_BEGIN) {
+                res = _begin_job(fd, header, &job);
+            } else if (header.type == SORT_FRAME_END) {
+                res = _finish_job(fd, &job);
+            } else if (header.type == SORT_FRAME_BATCH || header.type == SORT_FRAME_BATCH_FD) {
+                res = _add_batch(fd, header, passed_fd, &job);
+            } else {
+                _send_error(fd, "Unknown frame type.");
+                res = -1;
+            }
+            if (res != 0) {
+                break;
+            }
+        }
+        _clear_job(&job);
+        {
+            std::lock_guard<std::mutex> lock(_conn_mutex);
+            _conns.erase(fd);
+            close(fd);
+            // Notified under the lock, the server may be destroyed right after.
+            _conn_cond.notify_all();
+        }
+        return res;
+    }
+
+    /**
+     * The bytes of batches buffered now.
+     */
+    size_t memory_used() {
+        std::lock_guard<std::mutex> lock(_memory_mutex);
+        return _memory_used;
+    }
+
+private:
+    struct _Batch {
+        char*           data;
+        size_t          length;
+        uint32_t        count;
+        bool            mapped;
+        int             status;
+        vector<StrView> records;
+    };
+
+    struct _Job {
+        vector<_Batch*>         batches;
+        // The bytes got from the memory budget.
+        size_t                  held;
+        // Declared by SORT_FRAME_BEGIN, the batches take from held.
+        bool                    declared;
+        size_t                  used;
+        int                     pending;
+        std::mutex              mutex;
+        std::condition_variable cond;
+
+        _Job() : held(0), declared(false), used(0), pending(0) {}
+    };
+
+    // Declared first, so it is destroyed after the connections are gone.
+    SortWorkerPool          _pool;
+    size_t                  _memory_limit;
+    size_t                  _memory_used;
+    int64_t                 _wait_ms;
+    std::mutex              _memory_mutex;
+    std::condition_variable _memory_cond;
+    // Tickets of the jobs holding no memory yet and waiting for it, served in order.
+    deque<uint64_t>         _memory_queue;
+    uint64_t                _memory_ticket;
+    // Jobs holding memory, and those of them waiting for more.
+    int                     _holders;
+    int                     _waiting_holders;
+    int                     _listen_fd;
+    string                  _path;
+    bool                    _running;
+    // Read under both _conn_mutex and _memory_mutex.
+    std::atomic<bool>       _stopping;
+    std::thread             _acceptor;
+    set<int>                _conns;
+    std::mutex              _conn_mutex;
+    std::condition_variable _conn_cond;
+
+    SortServer(const SortServer&);
+    SortServer& operator=(const SortServer&);
+
+    void _accept_loop() {
+        while (true) {
+            int fd = accept4(_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0) {
+                std::lock_guard<std::mutex> lock(_conn_mutex);
+                if (_stopping) {
+                    return;
+                }
+                if (errno != EINTR && errno != ECONNABORTED) {
+                    toscreen << "Accept failed: " << strerror(errno) << ".\n";
+                    // E.g., out of fds, give the connections time to close.
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                continue;
+            }
+            std::thread(&SortServer::serve_fd, this, fd).detach();
+        }
+    }
+
+    /**
+     * Take bytes from the memory budget, wait while other connections hold it.
+     * A job holding nothing waits behind the earlier ones, a job holding memory
+     * only waits for the bytes, since it frees memory by going on.
+     * A job asking more than the whole budget fails at once, since it can
+     * not be served by waiting. So does a job holding memory when all the
+     * other holders wait too, none of them would release the memory.
+     * @return 0 means successfully.
+     */
+    int _acquire(_Job* job, size_t bytes) {
+        std::unique_lock<std::mutex> lock(_memory_mutex);
+        if (job->held + bytes > _memory_limit) {
+            return -1;
+        }
+        bool holding = job->held > 0;
+        uint64_t ticket = 0;
+        if (!holding) {
+            ticket = ++_memory_ticket;
+            _memory_queue.push_back(ticket);
+        } else {
+            if (_memory_used + bytes > _memory_limit && _waiting_holders + 1 == _holders) {
+                return -1;
+            }
+            ++_waiting_holders;
+        }
+        bool got = _memory_cond.wait_for(lock, std::chrono::milliseconds(_wait_ms), [&]() {
+            return _stopping || (_memory_used + bytes <= _memory_limit &&
+                                 (holding || _memory_queue.front() == ticket));
+        });
+        if (holding) {
+            --_waiting_holders;
+        } else {
+            _memory_queue.erase(std::find(_memory_queue.begin(), _memory_queue.end(), ticket));
+        }
+        if (got && !_stopping) {
+            _memory_used += bytes;
+            job->held += bytes;
+            if (!holding && job->held > 0) {
+                ++_holders;
+            }
+        }
+        lock.unlock();
+        if (!holding) {
+            // The next job in the queue may go now.
+            _memory_cond.notify_all();
+        }
+        return (got && !_stopping) ? 0 : -1;
+    }
+
+    void _release(_Job* job) {
+        {
+            std::lock_guard<std::mutex> lock(_memory_mutex);
+            if (job->held > 0) {
+                --_holders;
+            }
+            _memory_used -= job->held;
+            job->held = 0;
+        }
+        _memory_cond.notify_all();
+    }
+
+    int _send_error(int fd, const string& message) {
+        SortFrameHeader header;
+        header.type = SORT_FRAME_ERROR;
+        header.count = 0;
+        header.length = message.size();
+        struct iovec iov[2];
+        iov[0].iov_base = &header;
+        iov[0].iov_len = sizeof(header);
+        iov[1].iov_base = (void*)message.data();
+        iov[1].iov_len = message.size();
+        return _sortserver_send(fd, iov, 2);
+    }
+
+    /**
+     * Reserve the memory of the whole job, before any of its batches.
+     * @return 0 means successfully.
+     */
+    int _begin_job(int fd, const SortFrameHeader& header, _Job* job) {
+        uint64_t size[2];
+        if (header.length != sizeof(size) || _sortserver_recv(fd, size, sizeof(size)) != 0) {
+            _send_error(fd, "Bad job size.");
+            return -1;
+        }
+        if (job->declared || !job->batches.empty()) {
+            _send_error(fd, "The job size is declared after its batches.");
+            return -1;
+        }
+        // The same bytes as its batches take, see _add_batch.
+        if (size[0] > _memory_limit || size[1] > _memory_limit / sizeof(StrView) ||
+            _acquire(job, size[0] + size[1] * sizeof(StrView)) != 0) {
+            _send_error(fd, "Out of the memory budget.");
+            return -1;
+        }
+        job->declared = true;
+        return 0;
+    }
+
+    /**
+     * Read the batch and give it to the pool.
+     * @param passed_fd: The memfd of SORT_FRAME_BATCH_FD, always closed here.
+     * @return 0 means successfully.
+     */
+    int _add_batch(int fd, const SortFrameHeader& header, int passed_fd, _Job* job) {
+        if (header.type == SORT_FRAME_BATCH_FD && passed_fd == -1) {
+            _send_error(fd, "No memfd passed with the batch.");
+            return -1;
+        }
+        if (header.type == SORT_FRAME_BATCH_FD) {
+            // An unsealed fd shrunk by the client would kill the server by SIGBUS.
+            int seals = fcntl(passed_fd, F_GET_SEALS);
+            if (seals < 0 || (seals & SORTSERVER_MEMFD_SEALS) != SORTSERVER_MEMFD_SEALS) {
+                _send_error(fd, "The memfd is not sealed.");
+                close(passed_fd);
+                return -1;
+            }
+        }
+        if (header.length / sizeof(uint32_t) < header.count) {
+            _send_error(fd, "Bad batch size.");
+            if (passed_fd != -1) {
+                close(passed_fd);
+            }
+            return -1;
+        }
+        size_t bytes = header.length + header.count * sizeof(StrView);
+        if (job->declared && job->used + bytes > job->held) {
+            _send_error(fd, "The batch is over the declared job size.");
+            if (passed_fd != -1) {
+                close(passed_fd);
+            }
+            return -1;
+        }
+        job->used += bytes;
+        // Nothing read from the socket until the memory is got.
+        if (!job->declared && _acquire(job, bytes) != 0) {
+            _send_error(fd, "Out of the memory budget.");
+            if (passed_fd != -1) {
+                close(passed_fd);
+            }
+            return -1;
+        }
+        _Batch* batch = new _Batch;
+        batch->data = nullptr;
+        batch->length = header.length;
+        batch->count = header.count;
+        batch->mapped = false;
+        batch->status = 0;
+        job->batches.push_back(batch);
+
+        int res = 0;
+        if (header.type == SORT_FRAME_BATCH_FD) {
+            struct stat st;
+            if (fstat(passed_fd, &st) != 0 || (uint64_t)st.st_size < header.length) {
+                res = -1;
+            } else if (header.length > 0) {
+                void* addr = mmap(nullptr, header.length, PROT_READ, MAP_PRIVATE, passed_fd, 0);
+                if (addr == MAP_FAILED) {
+                    res = -1;
+                } else {
+                    batch->data = (char*)addr;
+                    batch->mapped = true;
+                }
+            }
+            close(passed_fd);
+        } else if (header.length > 0) {
+            batch->data = (char*)malloc(header.length);
+            if (batch->data == nullptr) {
+                res = -1;
+            } else {
+                res = (_sortserver_recv(fd, batch->data, header.length) == 0) ? 0 : -1;
+            }
+        }
+        if (res != 0) {
+            _send_error(fd, "Read batch failed.");
+            return -1;
+        }
+        {
+            std::lock_guard<std::mutex> lock(job->mutex);
+            ++job->pending;
+        }
+        _pool.submit([batch, job]() {
+            batch->status = _sortserver_parse(batch->data, batch->length, batch->count, &batch->records);
+            if (batch->status == 0) {
+                batch->status = tsort(batch->records.data(), batch->records.size(), _sort_record_cmp);
+            }
+            std::lock_guard<std::mutex> lock(job->mutex);
+            if (--job->pending == 0) {
+                job->cond.notify_all();
+            }
+        });
+        return 0;
+    }
+
+    void _wait_job(_Job* job) {
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->cond.wait(lock, [job]() { return job->pending == 0; });
+    }
+
+    /**
+     * Merge the sorted batches and send them, then start a new job.
+     * @return 0 means successfully.
+     */
+    int _finish_job(int fd, _Job* job) {
+        _wait_job(job);
+        for (size_t i = 0; i < job->batches.size(); ++i) {
+            if (job->batches[i]->status != 0) {
+                _send_error(fd, "Bad records in the batch.");
+                return -1;
+            }
+        }
+        vector<ArraySource<StrView> > sources;
+        sources.reserve(job->batches.size());
+        LoserTree<StrView> tree(_sort_record_cmp);
+        for (size_t i = 0; i < job->batches.size(); ++i) {
+            sources.push_back(ArraySource<StrView>(job->batches[i]->records.data(),
+                                                   job->batches[i]->records.size()));
+            tree.add_source(&sources.back());
+        }
+        tree.init();
+
+        StrView records[SORTSERVER_FRAME_RECORDS];
+        struct iovec iov[SORTSERVER_FRAME_RECORDS + 1];
+        SortFrameHeader header;
+        while (true) {
+            int64_t count = tree.next_batch(records, SORTSERVER_FRAME_RECORDS);
+            header.type = (count > 0) ? SORT_FRAME_BATCH : SORT_FRAME_END;
+            header.count = count;
+            header.length = 0;
+            iov[0].iov_base = &header;
+            iov[0].iov_len = sizeof(header);
+            for (int64_t i = 0; i < count; ++i) {
+                // The size prefix is still in front of the record in the buffer.
+                iov[i + 1].iov_base = (void*)(records[i].data - sizeof(uint32_t));
+                iov[i + 1].iov_len = records[i].size + sizeof(uint32_t);
+                header.length += iov[i + 1].iov_len;
+            }
+            if (_sortserver_send(fd, iov, count + 1) != 0) {
+                return -1;
+            }
+            if (count == 0) {
+                break;
+            }
+        }
+        _clear_job(job);
+        return 0;
+    }
+
+    void _clear_job(_Job* job) {
+        _wait_job(job);
+        for (size_t i = 0; i < job->batches.size(); ++i) {
+            _Batch* batch = job->batches[i];
+            if (batch->mapped) {
+                munmap(batch->data, batch->length);
+            } else {
+                free(batch->data);
+            }
+            delete batch;
+        }
+        job->batches.clear();
+        job->declared = false;
+        job->used = 0;
+        _release(job);
+    }
+};
+
+/**
+ * Client of SortServer, one job at a time.
+ */
+class SortClient {
+public:
+    SortClient() : _fd(-1), _pos(0), _left(0) {}
+    virtual ~SortClient() {
+        close();
+    }
+
+    /**
+     * @return 0 means successfully.
+     */
+    int connect(const string& path) {
+        struct sockaddr_un addr;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            toscreen << "The socket path is too long.\n";
+            return -1;
+        }
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        memcpy(addr.sun_path, path.data(), path.size());
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            toscreen << "Create socket failed: " << strerror(errno) << ".\n";
+            return -1;
+        }
+        if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+            toscreen << "Connect to " << path << " failed: " << strerror(errno) << ".\n";
+            ::close(fd);
+            return -1;
+        }
+        return attach(fd);
+    }
+
+    /**
+     * Use a connected socket, e.g., one end of a socketpair. The fd is owned by the client.
+     * @return 0 means successfully.
+     */
+    int attach(int fd) {
+        close();
+        _fd = fd;
+        return 0;
+    }
+
+    void close() {
+        if (_fd != -1) {
+            ::close(_fd);
+            _fd = -1;
+        }
+        _frame.clear();
+        _pos = 0;
+        _left = 0;
+    }
+
+    /**
+     * Declare the size of the job before its first batch, the server reserves
+     * the memory at once. Optional, but a job not declared may fail when the
+     * memory budget is short, see SortServer.
+     * @param bytes: The bytes of all the records of the job.
+     * @param records: The number of records of the job.
+     * @return 0 means successfully.
+     */
+    int begin(uint64_t bytes, uint64_t records) {
+        SortFrameHeader header;
+        header.type = SORT_FRAME_BEGIN;
+        header.count = 0;
+        uint64_t size[2];
+        size[0] = bytes + records * sizeof(uint32_t);
+        size[1] = records;
+        header.length = sizeof(size);
+        struct iovec iov[2];
+        iov[0].iov_base = &header;
+        iov[0].iov_len = sizeof(header);
+        iov[1].iov_base = size;
+        iov[1].iov_len = sizeof(size);
+        return _sortserver_send(_fd, iov, 2);
+    }
+
+    /**
+     * Send the records by sendmsg straight from the strings.
+     * @return 0 means successfully.
+     */
+    int send_batch(const vector<string>& records) {
+        vector<StrView> views(records.begin(), records.end());
+        return send_batch(views.data(), views.size());
+    }
+
+    int send_batch(const StrView* records, size_t count) {
+        if (count == 0) {
+            return 0;
+        }
+        vector<uint32_t> sizes(count);
+        vector<struct iovec> iov(count * 2 + 1);
+        SortFrameHeader header;
+        header.type = SORT_FRAME_BATCH;
+        header.count = count;
+        header.length = 0;
+        iov[0].iov_base = &header;
+        iov[0].iov_len = sizeof(header);
+        for (size_t i = 0; i < count; ++i) {
+            sizes[i] = records[i].size;
+            iov[i * 2 + 1].iov_base = &sizes[i];
+            iov[i * 2 + 1].iov_len = sizeof(uint32_t);
+            iov[i * 2 + 2].iov_base = (void*)records[i].data;
+            iov[i * 2 + 2].iov_len = records[i].size;
+            header.length += sizeof(uint32_t) + records[i].size;
+        }
+        return _sortserver_send(_fd, iov.data(), iov.size());
+    }
+
+    /**
+     * Write the records into a memfd and pass the fd, the socket carries only the header.
+     * The memfd is sealed, so its size and bytes are fixed once sent.
+     * Better for big batches.
+     * @return 0 means successfully.
+     */
+    int send_batch_memfd(const StrView* records, size_t count) {
+        if (count == 0) {
+            return 0;
+        }
+        SortFrameHeader header;
+        header.type = SORT_FRAME_BATCH_FD;
+        header.count = count;
+        header.length = 0;
+        for (size_t i = 0; i < count; ++i) {
+            header.length += sizeof(uint32_t) + records[i].size;
+        }
+        int memfd = memfd_create("wttool_sort_batch", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (memfd < 0) {
+            toscreen << "Create memfd failed: " << strerror(errno) << ".\n";
+            return -1;
+        }
+        if (ftruncate(memfd, header.length) != 0) {
+            ::close(memfd);
+            return -1;
+        }
+        void* addr = mmap(nullptr, header.length, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(memfd);
+            return -1;
+        }
+        char* cur = (char*)addr;
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t size = records[i].size;
+            memcpy(cur, &size, sizeof(size));
+            memcpy(cur + sizeof(size), records[i].data, size);
+            cur += sizeof(size) + size;
+        }
+        // F_SEAL_WRITE needs the writable mapping gone.
+        munmap(addr, header.length);
+        if (fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE) != 0) {
+            toscreen << "Seal memfd failed: " << strerror(errno) << ".\n";
+            ::close(memfd);
+            return -1;
+        }
+        struct iovec iov;
+        iov.iov_base = &header;
+        iov.iov_len = sizeof(header);
+        int res = _sortserver_send(_fd, &iov, 1, memfd);
+        ::close(memfd);
+        return res;
+    }
+
+    int send_batch_memfd(const vector<string>& records) {
+        vector<StrView> views(records.begin(), records.end());
+        return send_batch_memfd(views.data(), views.size());
+    }
+
+    /**
+     * End the job, the sorted records can be read by next().
+     * @return 0 means successfully.
+     */
+    int finish() {
+        SortFrameHeader header;
+        header.type = SORT_FRAME_END;
+        header.count = 0;
+        header.length = 0;
+        struct iovec iov;
+        iov.iov_base = &header;
+        iov.iov_len = sizeof(header);
+        return _sortserver_send(_fd, &iov, 1);
+    }
+
+    /**
+     * Get the next sorted record, valid until the next call.
+     * @return 0 means got a record, 1 means the job is done, -1 means error.
+     */
+    int next(StrView* record) {
+        while (_left == 0) {
+            SortFrameHeader header;
+            if (_sortserver_recv(_fd, &header, sizeof(header)) != 0) {
+                return -1;
+            }
+            _frame.resize(header.length);
+            if (header.length > 0 && _sortserver_recv(_fd, &_frame[0], header.length) != 0) {
+                return -1;
+            }
+            if (header.type == SORT_FRAME_END) {
+                return 1;
+            }
+            if (header.type != SORT_FRAME_BATCH) {
+                _error = _frame;
+                toscreen << "Sort server error: " << _error << "\n";
+                return -1;
+            }
+            _pos = 0;
+            _left = header.count;
+        }
+        uint32_t size = 0;
+        if (_frame.size() - _pos < sizeof(size)) {
+            return -1;
+        }
+        memcpy(&size, _frame.data() + _pos, sizeof(size));
+        _pos += sizeof(size);
+        if (_frame.size() - _pos < size) {
+            return -1;
+        }
+        *record = StrView(_frame.data() + _pos, size);
+        _pos += size;
+        --_left;
+        return 0;
+    }
+
+    /**
+     * Read all the sorted records of the job.
+     * @return 0 means successfully.
+     */
+    int read_all(vector<string>* records) {
+        StrView record;
+        int res = 0;
+        while ((res = next(&record)) == 0) {
+            records->push_back(record.str());
+        }
+        return (res == 1) ? 0 : -1;
+    }
+
+    /**
+     * The message of the last SORT_FRAME_ERROR.
+     */
+    const string& error() const {
+        return _error;
+    }
+
+private:
+    int      _fd;
+    string   _frame;
+    size_t   _pos;
+    uint32_t _left;
+    string   _error;
+
+    SortClient(const SortClient&);
+    SortClient& operator=(const SortClient&);
+};
+
+} // End namespace wttool.
+
+#endif // End ifdef __WTTOOL_SORTSERVER_HPP_.
@@ -0,0 +1,306 @@
+/**
+ * Sort instrumentation.
+ * Compile with -DWTTOOL_SORT_STATS to count comparisons, element moves,
+ * recursion depth, allocated bytes and time of every phase in sort.hpp.
+ * Without it, all the SORT_STAT_* macros are empty and cost nothing.
+ * Counters are kept per thread, sort_stats_collect() scrapes all threads.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_SORTSTAT_HPP_
+#define __WTTOOL_SORTSTAT_HPP_
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wttool {
+
+using namespace std;
+
+enum SortPhase {
+    SORT_PHASE_TOTAL = 0,   // Whole top level sort call.
+    SORT_PHASE_PARTITION,   // Quick Sort partition.
+    SORT_PHASE_RUN,         // Run detection and insertion.
+    SORT_PHASE_MERGE,       // Merging.
+    SORT_PHASE_COUNT
+};
+
+/**
+ * Plain copy of the counters.
+ */
+struct SortStatsSnapshot {
+    uint64_t comparisons;
+    uint64_t moves;
+    uint64_t max_depth;
+    uint64_t bytes_allocated;
+    uint64_t calls;
+    uint64_t phase_ns[SORT_PHASE_COUNT];
+
+    SortStatsSnapshot() : comparisons(0), moves(0), max_depth(0), bytes_allocated(0), calls(0) {
+        for (int i = 0; i < SORT_PHASE_COUNT; ++i) {
+            phase_ns[i] = 0;
+        }
+    }
+
+    void add(const SortStatsSnapshot& other) {
+        comparisons += other.comparisons;
+        moves += other.moves;
+        max_depth = (max_depth > other.max_depth) ? max_depth : other.max_depth;
+        bytes_allocated += other.bytes_allocated;
+        calls += other.calls;
+        for (int i = 0; i < SORT_PHASE_COUNT; ++i) {
+            phase_ns[i] += other.phase_ns[i];
+        }
+    }
+};
+
+/**
+ * Counters of one thread. Only the owner thread writes, others may read,
+ * so the counters are relaxed atomics updated without locked instructions.
+ */
+struct SortStats {
+    std::atomic<uint64_t> comparisons;
+    std::atomic<uint64_t> moves;
+    std::atomic<uint64_t> max_depth;
+    std::atomic<uint64_t> bytes_allocated;
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> phase_ns[SORT_PHASE_COUNT];
+    uint64_t              depth;
+
+    SortStats() : depth(0) {
+        reset();
+    }
+
+    void reset() {
+        comparisons.store(0, std::memory_order_relaxed);
+        moves.store(0, std::memory_order_relaxed);
+        max_depth.store(0, std::memory_order_relaxed);
+        bytes_allocated.store(0, std::memory_order_relaxed);
+        calls.store(0, std::memory_order_relaxed);
+        for (int i = 0; i < SORT_PHASE_COUNT; ++i) {
+            phase_ns[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    static void inc(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    SortStatsSnapshot snapshot() const {
+        SortStatsSnapshot res;
+        res.comparisons = comparisons.load(std::memory_order_relaxed);
+        res.moves = moves.load(std::memory_order_relaxed);
+        res.max_depth = max_depth.load(std::memory_order_relaxed);
+        res.bytes_allocated = bytes_allocated.load(std::memory_order_relaxed);
+        res.calls = calls.load(std::memory_order_relaxed);
+        for (int i = 0; i < SORT_PHASE_COUNT; ++i) {
+            res.phase_ns[i] = phase_ns[i].load(std::memory_order_relaxed);
+        }
+        return res;
+    }
+};
+
+/**
+ * All threads' counters. Counters of exited threads are folded into _retired.
+ * Shared by all translation units, so the functions below are inline.
+ */
+class SortStatsRegistry {
+public:
+    static SortStatsRegistry& instance() {
+        static SortStatsRegistry registry;
+        return registry;
+    }
+
+    void add(SortStats* stats) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _threads.push_back(stats);
+    }
+
+    void remove(SortStats* stats) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (size_t i = 0; i < _threads.size(); ++i) {
+            if (_threads[i] == stats) {
+                _retired.add(stats->snapshot());
+                _threads.erase(_threads.begin() + i);
+                break;
+            }
+        }
+    }
+
+    /**
+     * @param per_thread: If not nullptr, filled with the counters of living threads.
+     * @return The sum of all threads, including exited ones.
+     */
+    SortStatsSnapshot collect(vector<SortStatsSnapshot>* per_thread) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        SortStatsSnapshot total = _retired;
+        if (per_thread != nullptr) {
+            per_thread->clear();
+        }
+        for (size_t i = 0; i < _threads.size(); ++i) {
+            SortStatsSnapshot cur = _threads[i]->snapshot();
+            total.add(cur);
+            if (per_thread != nullptr) {
+                per_thread->push_back(cur);
+            }
+        }
+        return total;
+    }
+
+private:
+    std::mutex          _mutex;
+    vector<SortStats*>  _threads;
+    SortStatsSnapshot   _retired;
+};
+
+/**
+ * Registers the thread's counters while the thread lives.
+ */
+class SortStatsHolder {
+public:
+    SortStatsHolder() {
+        SortStatsRegistry::instance().add(&stats);
+    }
+    ~SortStatsHolder() {
+        SortStatsRegistry::instance().remove(&stats);
+    }
+    SortStats stats;
+};
+
+/**
+ * Counters of the current thread.
+ */
+inline SortStats& sort_stats() {
+    static thread_local SortStatsHolder holder;
+    return holder.stats;
+}
+
+/**
+ * Sum of all threads, optionally with the per thread counters.
+ */
+inline SortStatsSnapshot sort_stats_collect(vector<SortStatsSnapshot>* per_thread = nullptr) {
+    return SortStatsRegistry::instance().collect(per_thread);
+}
+
+/**
+ * Print the counters in one line.
+ * E.g., comparisons=10 moves=20 max_depth=3 bytes_allocated=0 calls=1 total_ns=100 ...
+ */
+inline string print_sort_stats(const SortStatsSnapshot& stats) {
+    static const char* phase_names[SORT_PHASE_COUNT] = {"total", "partition", "run", "merge"};
+    stringstream ss;
+    ss << "comparisons=" << stats.comparisons << " moves=" << stats.moves
+       << " max_depth=" << stats.max_depth << " bytes_allocated=" << stats.bytes_allocated
+       << " calls=" << stats.calls;
+    for (int i = 0; i < SORT_PHASE_COUNT; ++i) {
+        ss << " " << phase_names[i] << "_ns=" << stats.phase_ns[i];
+    }
+    return ss.str();
+}
+
+/**
+ * Counts one level of sort recursion, a top level call is also timed as
+ * SORT_PHASE_TOTAL.
+ */
+class SortDepthScope {
+public:
+    SortDepthScope() : _stats(sort_stats()) {
+        if (++_stats.depth > _stats.max_depth.load(std::memory_order_relaxed)) {
+            _stats.max_depth.store(_stats.depth, std::memory_order_relaxed);
+        }
+        if (_stats.depth == 1) {
+            SortStats::inc(_stats.calls, 1);
+            _begin = std::chrono::steady_clock::now();
+        }
+    }
+    ~SortDepthScope() {
+        if (_stats.depth == 1) {
+            uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - _begin).count();
+            SortStats::inc(_stats.phase_ns[SORT_PHASE_TOTAL], ns);
+        }
+        --_stats.depth;
+    }
+
+private:
+    SortStats& _stats;
+    std::chrono::steady_clock::time_point _begin;
+};
+
+/**
+ * Times the enclosing block as the phase.
+ */
+class SortPhaseScope {
+public:
+    SortPhaseScope(SortPhase phase) : _phase(phase), _begin(std::chrono::steady_clock::now()) {}
+    ~SortPhaseScope() {
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - _begin).count();
+        SortStats::inc(sort_stats().phase_ns[_phase], ns);
+    }
+
+private:
+    SortPhase _phase;
+    std::chrono::steady_clock::time_point _begin;
+};
+
+/**
+ * Counts the calls of the user's comparison function.
+ * The function is kept per thread and per type, so sort.hpp keeps passing
+ * plain function pointers.
+ */
+template <typename T>
+struct SortCompareHook {
+    static int (*&original())(const T& lhs, const T& rhs) {
+        static thread_local int (*func)(const T& lhs, const T& rhs) = nullptr;
+        return func;
+    }
+
+    static int counted(const T& lhs, const T& rhs) {
+        SortStats::inc(sort_stats().comparisons, 1);
+        return original()(lhs, rhs);
+    }
+
+    /**
+     * @return The counting function to be used instead of compare.
+     */
+    static int (*wrap(int (*compare)(const T& lhs, const T& rhs)))(const T& lhs, const T& rhs) {
+        if (compare != &counted) {
+            original() = compare;
+        }
+        return &counted;
+    }
+};
+
+} // End namespace wttool.
+
+#ifdef WTTOOL_SORT_STATS
+#define SORT_STAT_CALL(T, compare) \
+    wttool::SortDepthScope _sort_depth_scope; \
+    compare = wttool::SortCompareHook<T>::wrap(compare)
+#define SORT_STAT_PHASE(phase) wttool::SortPhaseScope _sort_phase_scope(phase)
+#define SORT_STAT_MOVE(n) wttool::SortStats::inc(wttool::sort_stats().moves, (n))
+#define SORT_STAT_ALLOC(bytes) wttool::SortStats::inc(wttool::sort_stats().bytes_allocated, (bytes))
+#define SORT_STAT_DEPTH(n) \
+    do { \
+        wttool::SortStats& _sort_stats = wttool::sort_stats(); \
+        if ((uint64_t)(n) + _sort_stats.depth > _sort_stats.max_depth.load(std::memory_order_relaxed)) { \
+            _sort_stats.max_depth.store((uint64_t)(n) + _sort_stats.depth, std::memory_order_relaxed); \
+        } \
+    } while (0)
+#else
+#define SORT_STAT_CALL(T, compare) ((void)0)
+#define SORT_STAT_PHASE(phase) ((void)0)
+#define SORT_STAT_MOVE(n) ((void)0)
+#define SORT_STAT_ALLOC(bytes) ((void)0)
+#define SORT_STAT_DEPTH(n) ((void)0)
+#endif
+
+#endif // End ifdef __WTTOOL_SORTSTAT_HPP_.
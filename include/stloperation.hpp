@@ -33,6 +33,25 @@
 
 namespace wttool {
 
+using namespace std;
+
+/**
+ * A non-owning view of bytes, e.g., a line inside a mapped file.
+ * The viewed memory must outlive the view.
+ */
+struct StrView {
+    const char* data;
+    size_t      size;
+
+    StrView() : data(nullptr), size(0) {}
+    StrView(const char* d, size_t s) : data(d), size(s) {}
+    StrView(const string& str) : data(str.data()), size(str.size()) {}
+
+    string str() const {
+        return string(data, size);
+    }
+};
+
 /**
  * Split string by token.
  * @param str: The string to be split.
@@ -59,6 +78,42 @@ static vector<string> splitstr(const string& str, const string& token = " ") {
     return res;
 }
 
+/**
+ * Split bytes by token without copying, empty fields are skipped as splitstr does.
+ * @param res: Cleared and filled with views pointing into [data, data + length).
+ * @return The number of fields.
+ */
+static size_t splitstr(const char* data, size_t length, const string& token, vector<StrView>* res) {
+    res->clear();
+    if (token.empty()) {
+        if (length != 0) {
+            res->push_back(StrView(data, length));
+        }
+        return res->size();
+    }
+    const char* cur = data;
+    const char* end = data + length;
+    while (cur < end) {
+        const char* found = nullptr;
+        if (token.size() == 1) {
+            found = (const char*)memchr(cur, token[0], end - cur);
+        } else {
+            found = (const char*)memmem(cur, end - cur, token.data(), token.size());
+        }
+        if (found == nullptr) {
+            break;
+        }
+        if (found != cur) {
+            res->push_back(StrView(cur, found - cur));
+        }
+        cur = found + token.size();
+    }
+    if (cur < end) {
+        res->push_back(StrView(cur, end - cur));
+    }
+    return res->size();
+}
+
 /**
  * String to number.
  */
@@ -68,6 +123,30 @@ static int64_t str2num(const string& str) {
     return num;
 }
 
+/**
+ * Bytes to number, without making a null-terminated copy.
+ * Leading white spaces (" \t\n\v\f\r", as skipped by sscanf in the string one)
+ * and a sign are accepted, parsing stops at the first non-digit.
+ */
+static int64_t str2num(const StrView& str) {
+    const char* cur = str.data;
+    const char* end = str.data + str.size;
+    while (cur < end && (*cur == ' ' || (*cur >= '\t' && *cur <= '\r'))) {
+        ++cur;
+    }
+    bool negative = false;
+    if (cur < end && (*cur == '-' || *cur == '+')) {
+        negative = (*cur == '-');
+        ++cur;
+    }
+    uint64_t num = 0;
+    while (cur < end && *cur >= '0' && *cur <= '9') {
+        num = num * 10 + (*cur - '0');
+        ++cur;
+    }
+    return negative ? (int64_t)(0 - num) : (int64_t)num;
+}
+
 /**
  * Number to string.
  */
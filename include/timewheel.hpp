@@ -0,0 +1,349 @@
+/**
+ * Hierarchical timing wheel for a large number of timeouts.
+ * Schedule, cancel and reschedule are O(1), timer nodes are pooled and
+ * addressed by index, so arming a timer does not malloc once the pool is warm.
+ * Time is in milliseconds from the monotonic clock, or driven manually by
+ * advance() for deterministic tests. Not thread safe.
+ * E.g.,
+ *     TimeWheel wheel;
+ *     uint64_t id = wheel.schedule(3000, on_timeout, conn);
+ *     wheel.cancel(id);
+ *     ...
+ *     wheel.poll();    // In the event loop.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_TIMEWHEEL_HPP_
+#define __WTTOOL_TIMEWHEEL_HPP_
+
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+
+// Level 0 has 256 slots of 1ms, upper levels have 64 slots each 64 times longer.
+#define TIMEWHEEL_LEVEL0_BITS 8
+#define TIMEWHEEL_LEVEL_BITS 6
+#define TIMEWHEEL_LEVELS 5
+
+namespace wttool {
+
+using namespace std;
+
+/**
+ * Called when the timer expires, the id is not valid any more.
+ */
+typedef void (*TimerCallback)(uint64_t id, void* arg);
+
+class TimeWheel {
+public:
+    /**
+     * @param now_ms: Start time, the monotonic clock by default.
+     * @param reserved: The reserved timer nodes, if over, it will automatically expand.
+     */
+    TimeWheel(uint64_t now_ms = monotonic_ms(), size_t reserved = 1024) :
+        _now(now_ms), _size(0), _free(NIL) {
+        _heads.assign(SLOT_COUNT + 1, (uint32_t)NIL);
+        for (int i = 0; i < TIMEWHEEL_LEVELS; ++i) {
+            _counts[i] = 0;
+        }
+        _nodes.reserve(reserved);
+    }
+    virtual ~TimeWheel() {}
+
+    /**
+     * Milliseconds of CLOCK_MONOTONIC.
+     */
+    static uint64_t monotonic_ms() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+    }
+
+    /**
+     * Arm a timer expiring delay_ms later, at least 1ms.
+     * @return The timer id, never 0.
+     */
+    uint64_t schedule(uint64_t delay_ms, TimerCallback callback, void* arg = nullptr) {
+        uint32_t index = _alloc();
+        Node& node = _nodes[index];
+        node.callback = callback;
+        node.arg = arg;
+        node.expire = _now + ((delay_ms == 0) ? 1 : delay_ms);
+        _link(index);
+        ++_size;
+        return _make_id(index, node.gen);
+    }
+
+    /**
+     * Disarm the timer.
+     * @return 0 means successfully, -1 means the timer has expired or been cancelled.
+     */
+    int cancel(uint64_t id) {
+        uint32_t index = 0;
+        if (_find(id, &index) != 0) {
+            return -1;
+        }
+        _unlink(index);
+        _release(index);
+        --_size;
+        return 0;
+    }
+
+    /**
+     * Move the timer to expire delay_ms from now, at least 1ms. The id is kept.
+     * @return 0 means successfully, -1 means the timer has expired or been cancelled.
+     */
+    int reschedule(uint64_t id, uint64_t delay_ms) {
+        uint32_t index = 0;
+        if (_find(id, &index) != 0) {
+            return -1;
+        }
+        _unlink(index);
+        _nodes[index].expire = _now + ((delay_ms == 0) ? 1 : delay_ms);
+        _link(index);
+        return 0;
+    }
+
+    /**
+     * Run the ticks up to now_ms, expired timers of each tick are run as a batch.
+     * Callbacks may schedule or cancel timers.
+     * @return The number of expired timers.
+     */
+    int64_t advance_to(uint64_t now_ms) {
+        int64_t expired = 0;
+        while (_now < now_ms) {
+            if (_size == 0) {
+                _now = now_ms;
+                break;
+            }
+            // Skip the ticks before the next cascade of the lowest non-empty level.
+            int level = 0;
+            while (level < TIMEWHEEL_LEVELS && _counts[level] == 0) {
+                ++level;
+            }
+            if (level > 0 && level < TIMEWHEEL_LEVELS) {
+                uint64_t last = _now | (((uint64_t)1 << _shift_of(level)) - 1);
+                if (last >= now_ms) {
+                    _now = now_ms;
+                    break;
+                }
+                _now = last;
+            }
+            ++_now;
+            _cascade();
+            uint32_t slot = _now & ((1 << TIMEWHEEL_LEVEL0_BITS) - 1);
+            if (_heads[slot] == NIL) {
+                continue;
+            }
+            // Move the whole slot to the expiring list, then run it.
+            _heads[EXPIRING] = _heads[slot];
+            _heads[slot] = NIL;
+            for (uint32_t i = _heads[EXPIRING]; i != NIL; i = _nodes[i].next) {
+                _nodes[i].slot = EXPIRING;
+                --_counts[0];
+            }
+            while (_heads[EXPIRING] != NIL) {
+                uint32_t index = _heads[EXPIRING];
+                _unlink(index);
+                TimerCallback callback = _nodes[index].callback;
+                void* arg = _nodes[index].arg;
+                uint64_t id = _make_id(index, _nodes[index].gen);
+                _release(index);
+                --_size;
+                ++expired;
+                if (callback != nullptr) {
+                    callback(id, arg);
+                }
+            }
+        }
+        return expired;
+    }
+
+    /**
+     * Run the ticks of ms milliseconds.
+     * @return The number of expired timers.
+     */
+    int64_t advance(uint64_t ms) {
+        return advance_to(_now + ms);
+    }
+
+    /**
+     * Run the ticks up to the monotonic clock.
+     * @return The number of expired timers.
+     */
+    int64_t poll() {
+        return advance_to(monotonic_ms());
+    }
+
+    uint64_t now() const {
+        return _now;
+    }
+
+    /**
+     * The number of armed timers.
+     */
+    size_t size() const {
+        return _size;
+    }
+
+private:
+    enum : uint32_t {
+        NIL = 0xffffffff,
+        SLOT_COUNT = (1 << TIMEWHEEL_LEVEL0_BITS) + (TIMEWHEEL_LEVELS - 1) * (1 << TIMEWHEEL_LEVEL_BITS),
+        // The list holding the timers of the tick being run.
+        EXPIRING = SLOT_COUNT
+    };
+
+    struct Node {
+        uint64_t      expire;
+        TimerCallback callback;
+        void*         arg;
+        uint32_t      prev;
+        uint32_t      next;
+        uint32_t      slot;
+        uint32_t      gen;
+    };
+
+    uint64_t         _now;
+    size_t           _size;
+    // The number of timers in every level.
+    size_t           _counts[TIMEWHEEL_LEVELS];
+    uint32_t         _free;
+    vector<Node>     _nodes;
+    vector<uint32_t> _heads;
+
+    static uint64_t _make_id(uint32_t index, uint32_t gen) {
+        return ((uint64_t)gen << 32) | ((uint64_t)index + 1);
+    }
+
+    int _find(uint64_t id, uint32_t* index) const {
+        uint64_t pos = (id & 0xffffffff);
+        if (pos == 0 || pos > _nodes.size()) {
+            return -1;
+        }
+        const Node& node = _nodes[pos - 1];
+        if (node.slot == NIL || node.gen != (uint32_t)(id >> 32)) {
+            return -1;
+        }
+        *index = pos - 1;
+        return 0;
+    }
+
+    uint32_t _alloc() {
+        if (_free != NIL) {
+            uint32_t index = _free;
+            _free = _nodes[index].next;
+            return index;
+        }
+        Node node;
+        node.gen = 0;
+        node.slot = NIL;
+        _nodes.push_back(node);
+        return _nodes.size() - 1;
+    }
+
+    void _release(uint32_t index) {
+        Node& node = _nodes[index];
+        node.slot = NIL;
+        ++node.gen;
+        node.next = _free;
+        _free = index;
+    }
+
+    /**
+     * Level L slots are 1 << _shift_of(L) milliseconds long.
+     */
+    static int _shift_of(int level) {
+        return (level == 0) ? 0 : TIMEWHEEL_LEVEL0_BITS + (level - 1) * TIMEWHEEL_LEVEL_BITS;
+    }
+
+    static int _level_of(uint32_t slot) {
+        if (slot >= SLOT_COUNT) {
+            return -1;
+        }
+        if (slot < (1 << TIMEWHEEL_LEVEL0_BITS)) {
+            return 0;
+        }
+        return 1 + ((slot - (1 << TIMEWHEEL_LEVEL0_BITS)) >> TIMEWHEEL_LEVEL_BITS);
+    }
+
+    /**
+     * Find the slot by how far the timer is from now.
+     */
+    uint32_t _slot_of(uint64_t expire) const {
+        uint64_t diff = (expire > _now) ? expire - _now : 0;
+        if (diff < ((uint64_t)1 << TIMEWHEEL_LEVEL0_BITS)) {
+            return expire & ((1 << TIMEWHEEL_LEVEL0_BITS) - 1);
+        }
+        uint32_t base = 1 << TIMEWHEEL_LEVEL0_BITS;
+        for (int level = 1; level < TIMEWHEEL_LEVELS; ++level) {
+            int shift = _shift_of(level);
+            if (diff < ((uint64_t)1 << (shift + TIMEWHEEL_LEVEL_BITS)) || level == TIMEWHEEL_LEVELS - 1) {
+                if (diff >= ((uint64_t)1 << (shift + TIMEWHEEL_LEVEL_BITS))) {
+                    // Too far, park it in the farthest slot, it is placed again when cascaded.
+                    expire = _now + ((uint64_t)1 << (shift + TIMEWHEEL_LEVEL_BITS)) - 1;
+                }
+                return base + ((expire >> shift) & ((1 << TIMEWHEEL_LEVEL_BITS) - 1));
+            }
+            base += 1 << TIMEWHEEL_LEVEL_BITS;
+        }
+        return 0;
+    }
+
+    void _link(uint32_t index) {
+        Node& node = _nodes[index];
+        node.slot = _slot_of(node.expire);
+        node.prev = NIL;
+        node.next = _heads[node.slot];
+        if (node.next != NIL) {
+            _nodes[node.next].prev = index;
+        }
+        _heads[node.slot] = index;
+        ++_counts[_level_of(node.slot)];
+    }
+
+    void _unlink(uint32_t index) {
+        Node& node = _nodes[index];
+        if (node.prev != NIL) {
+            _nodes[node.prev].next = node.next;
+        } else {
+            _heads[node.slot] = node.next;
+        }
+        if (node.next != NIL) {
+            _nodes[node.next].prev = node.prev;
+        }
+        int level = _level_of(node.slot);
+        if (level >= 0) {
+            --_counts[level];
+        }
+    }
+
+    /**
+     * When a lower level wraps, spread the current slot of the upper level
+     * into lower levels.
+     */
+    void _cascade() {
+        uint32_t base = 1 << TIMEWHEEL_LEVEL0_BITS;
+        for (int level = 1; level < TIMEWHEEL_LEVELS; ++level) {
+            int shift = _shift_of(level);
+            if ((_now & (((uint64_t)1 << shift) - 1)) != 0) {
+                return;
+            }
+            uint32_t slot = base + ((_now >> shift) & ((1 << TIMEWHEEL_LEVEL_BITS) - 1));
+            uint32_t index = _heads[slot];
+            _heads[slot] = NIL;
+            while (index != NIL) {
+                uint32_t next = _nodes[index].next;
+                --_counts[level];
+                _link(index);
+                index = next;
+            }
+            base += 1 << TIMEWHEEL_LEVEL_BITS;
+        }
+    }
+};
+
+} // End namespace wttool.
+
+#endif // End ifdef __WTTOOL_TIMEWHEEL_HPP_.
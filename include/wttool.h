@@ -18,6 +18,14 @@
 #include "sort.hpp"
 #include "compare.hpp"
 #include "systool.hpp"
+#include "keyencode.hpp"
+#include "linereader.hpp"
+#include "merge.hpp"
+#include "setop.hpp"
+#include "timewheel.hpp"
+#include "interner.hpp"
+#include "searchindex.hpp"
+#include "sortserver.hpp"
 
 namespace wttool {
 
@@ -0,0 +1,26 @@
+/**
+ * Minimal checks for the test programs, kept in release builds.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#ifndef __WTTOOL_TEST_HPP_
+#define __WTTOOL_TEST_HPP_
+
+#include <stdio.h>
+
+static int g_test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s, %d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            ++g_test_failures; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() \
+    (printf("%s: %s\n", __FILE__, (g_test_failures == 0) ? "passed" : "failed"), \
+     (g_test_failures == 0) ? 0 : 1)
+
+#endif // End ifdef __WTTOOL_TEST_HPP_.
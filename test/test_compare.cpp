@@ -0,0 +1,75 @@
+/**
+ * Tests of cmp<string> and cmp<PrefixString> against std::string::compare,
+ * which compares bytes as unsigned char.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "compare.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+static int sign(int res) {
+    return (res > 0) - (res < 0);
+}
+
+/**
+ * Strings of length 0 to 12 over bytes around the sign boundary and NUL,
+ * so lengths below, at and over the 8 byte prefix share prefixes often.
+ */
+static vector<string> make_strings(std::mt19937& gen, size_t count) {
+    const char bytes[] = {'\0', '\x01', 'a', '\x7f', '\x80', '\xff'};
+    vector<string> res;
+    for (size_t i = 0; i < count; ++i) {
+        string str(gen() % 13, 'a');
+        for (size_t j = 0; j < str.size(); ++j) {
+            str[j] = bytes[gen() % ((j < 6) ? 2 : sizeof(bytes))];
+        }
+        res.push_back(str);
+    }
+    return res;
+}
+
+static void test_regression() {
+    // Bytes >= 0x80 go after ASCII.
+    CHECK(cmp<string>("\x80", "a") > 0);
+    CHECK(cmp<string>("\xff", "\x7f") > 0);
+    CHECK(cmp<string>(string("a\0", 2), "a") > 0);
+    CHECK(cmp<string>("", "") == 0);
+    CHECK(cmp<PrefixString>(PrefixString("\x80"), PrefixString("a")) > 0);
+    // Equal prefixes, the zero padding does not make them equal.
+    CHECK(cmp<PrefixString>(PrefixString("a"), PrefixString(string("a\0", 2))) < 0);
+    CHECK(cmp<PrefixString>(PrefixString(string(8, '\0')), PrefixString("")) > 0);
+    CHECK(cmp<PrefixString>(PrefixString("abcdefgh"), PrefixString("abcdefgh")) == 0);
+    CHECK(cmp<PrefixString>(PrefixString("abcdefgh"), PrefixString("abcdefgh\x01")) < 0);
+    CHECK(cmp<PrefixString>(PrefixString("abcdefgh\xff"), PrefixString("abcdefgh\x01")) > 0);
+    PrefixString str("zzz");
+    str.reset("a");
+    CHECK(cmp<PrefixString>(str, PrefixString("b")) < 0);
+}
+
+static void test_random() {
+    std::mt19937 gen(27);
+    vector<string> strs = make_strings(gen, 600);
+    vector<PrefixString> prefixed(strs.begin(), strs.end());
+    for (size_t i = 0; i < strs.size(); ++i) {
+        for (size_t j = 0; j < strs.size(); ++j) {
+            int expect = sign(strs[i].compare(strs[j]));
+            CHECK(cmp<string>(strs[i], strs[j]) == expect);
+            CHECK(cmp<PrefixString>(prefixed[i], prefixed[j]) == expect);
+        }
+    }
+}
+
+int main() {
+    test_regression();
+    test_random();
+    return TEST_RESULT();
+}
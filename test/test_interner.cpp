@@ -0,0 +1,71 @@
+/**
+ * Tests of StrInterner, including ids used right after a concurrent intern.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "interner.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+static void test_basic() {
+    StrInterner interner(4);
+    uint32_t a = interner.intern("alpha");
+    uint32_t b = interner.intern(string("beta"));
+    CHECK(a == 0 && b == 1);
+    CHECK(interner.intern(StrView("alpha", 5)) == a);
+    CHECK(interner.get(b).str() == "beta");
+    CHECK(interner.get(b).data[4] == '\0');
+    CHECK(interner.hash(a) == hash_bytes("alpha", 5));
+    uint32_t id = 0;
+    CHECK(interner.find("beta", 4, &id) == 0 && id == b);
+    CHECK(interner.find("gamma", 5, &id) == -1);
+    CHECK(interner.get(100).size == 0);
+    vector<uint32_t> ids;
+    CHECK(interner.intern_split("beta,,alpha,x", ",", &ids) == 3);
+    CHECK(ids.size() == 3 && ids[0] == b && ids[1] == a && interner.get(ids[2]).str() == "x");
+    CHECK(interner.size() == 3);
+}
+
+/**
+ * Every thread interns overlapping strings and reads back each id at once,
+ * the tables grow meanwhile.
+ */
+static void test_concurrent() {
+    StrInterner interner(16);
+    std::atomic<int> failures(0);
+    vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.push_back(std::thread([&interner, &failures, t]() {
+            for (int i = 0; i < 20000; ++i) {
+                string str = "token_" + std::to_string((i * 7 + t * 13) % 30000);
+                uint32_t id = interner.intern(str);
+                if (interner.get(id).str() != str || interner.hash(id) != hash_bytes(str.data(), str.size())) {
+                    ++failures;
+                }
+            }
+        }));
+    }
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].join();
+    }
+    CHECK(failures.load() == 0);
+    for (uint32_t id = 0; id < interner.size(); ++id) {
+        uint32_t found = 0;
+        StrView str = interner.get(id);
+        CHECK(interner.find(str.data, str.size, &found) == 0 && found == id);
+    }
+}
+
+int main() {
+    test_basic();
+    test_concurrent();
+    return TEST_RESULT();
+}
@@ -0,0 +1,191 @@
+/**
+ * Tests of KeyEncoder and KeyDecoder, the order of encoded keys by cmp<string>
+ * against the field by field order of the tuples, and the round trips.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <math.h>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "compare.hpp"
+#include "keyencode.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+struct Tuple {
+    string   name;      // Ascending.
+    int64_t  time;      // Descending.
+    double   score;     // Ascending.
+    string   tag;       // Descending.
+    int32_t  level;     // Ascending.
+    float    weight;    // Descending.
+    uint64_t id;        // Ascending.
+    uint32_t flags;     // Descending.
+};
+
+template <typename T>
+static int sign(const T& lhs, const T& rhs) {
+    return (lhs < rhs) ? -1 : ((rhs < lhs) ? 1 : 0);
+}
+
+/**
+ * NaN goes after everything, -0.0 equals 0.0.
+ */
+template <typename T>
+static int float_sign(T lhs, T rhs) {
+    if (lhs != lhs || rhs != rhs) {
+        return (lhs != lhs) - (rhs != rhs);
+    }
+    return sign(lhs, rhs);
+}
+
+static int string_sign(const string& lhs, const string& rhs) {
+    int res = lhs.compare(rhs);
+    return (res < 0) ? -1 : ((res > 0) ? 1 : 0);
+}
+
+static int tuple_cmp(const Tuple& lhs, const Tuple& rhs) {
+    int res = string_sign(lhs.name, rhs.name);
+    res = (res != 0) ? res : -sign(lhs.time, rhs.time);
+    res = (res != 0) ? res : float_sign(lhs.score, rhs.score);
+    res = (res != 0) ? res : -string_sign(lhs.tag, rhs.tag);
+    res = (res != 0) ? res : sign(lhs.level, rhs.level);
+    res = (res != 0) ? res : -float_sign(lhs.weight, rhs.weight);
+    res = (res != 0) ? res : sign(lhs.id, rhs.id);
+    res = (res != 0) ? res : -sign(lhs.flags, rhs.flags);
+    return res;
+}
+
+static string encode(const Tuple& tuple) {
+    KeyEncoder enc;
+    enc.append_string(tuple.name);
+    enc.append_int64(tuple.time, true);
+    enc.append_double(tuple.score);
+    enc.append_string(tuple.tag, true);
+    enc.append_int32(tuple.level);
+    enc.append_float(tuple.weight, true);
+    enc.append_uint64(tuple.id);
+    enc.append_uint32(tuple.flags, true);
+    return enc.key();
+}
+
+/**
+ * @return 0 means all fields are read and the key is used up.
+ */
+static int decode(const string& key, Tuple* tuple) {
+    KeyDecoder dec(key);
+    if (dec.read_string(&tuple->name) != 0 || dec.read_int64(&tuple->time, true) != 0 ||
+        dec.read_double(&tuple->score) != 0 || dec.read_string(&tuple->tag, true) != 0 ||
+        dec.read_int32(&tuple->level) != 0 || dec.read_float(&tuple->weight, true) != 0 ||
+        dec.read_uint64(&tuple->id) != 0 || dec.read_uint32(&tuple->flags, true) != 0) {
+        return -1;
+    }
+    return dec.done() ? 0 : -1;
+}
+
+template <typename T>
+static bool same_float(T lhs, T rhs) {
+    return (lhs != lhs) ? (rhs != rhs) : (lhs == rhs && signbit(lhs) == signbit(rhs));
+}
+
+static Tuple make_tuple(std::mt19937_64& gen) {
+    // Prefixes of each other, embedded NUL bytes and bytes >= 0x80.
+    static const string strings[] = {string(), string("a"), string("ab"), string("a\0", 2),
+                                     string("a\0b", 3), string("\0", 1), string("\0\0", 2),
+                                     string("\xff"), string("\x01"), string("b"), string("ab\xff")};
+    const double inf = std::numeric_limits<double>::infinity();
+    const double doubles[] = {-inf, -1e300, -1.5, -0.0, 0.0, 5e-324, 1.5, 1e300, inf, NAN};
+    const float floats[] = {-INFINITY, -2.5f, -0.0f, 0.0f, 1e-45f, 2.5f, INFINITY, NAN};
+    const int64_t int64s[] = {INT64_MIN, INT64_MIN + 1, -1, 0, 1, INT64_MAX - 1, INT64_MAX};
+    const int32_t int32s[] = {INT32_MIN, -1, 0, 1, INT32_MAX};
+    const uint64_t uint64s[] = {0, 1, 0xff, 0x100, UINT64_MAX - 1, UINT64_MAX};
+    const uint32_t uint32s[] = {0, 1, 0x80000000U, UINT32_MAX};
+    const size_t string_count = sizeof(strings) / sizeof(strings[0]);
+    Tuple tuple;
+    tuple.name = strings[gen() % string_count];
+    tuple.time = int64s[gen() % (sizeof(int64s) / sizeof(int64s[0]))];
+    tuple.score = doubles[gen() % (sizeof(doubles) / sizeof(doubles[0]))];
+    tuple.tag = strings[gen() % string_count];
+    tuple.level = int32s[gen() % (sizeof(int32s) / sizeof(int32s[0]))];
+    tuple.weight = floats[gen() % (sizeof(floats) / sizeof(floats[0]))];
+    tuple.id = uint64s[gen() % (sizeof(uint64s) / sizeof(uint64s[0]))];
+    tuple.flags = uint32s[gen() % (sizeof(uint32s) / sizeof(uint32s[0]))];
+    return tuple;
+}
+
+static void test_order() {
+    std::mt19937_64 gen(28);
+    for (int i = 0; i < 200000; ++i) {
+        Tuple lhs = make_tuple(gen);
+        Tuple rhs = make_tuple(gen);
+        // Equal leading fields, so the later fields decide often.
+        if (gen() % 2 == 0) {
+            rhs.name = lhs.name;
+            rhs.time = lhs.time;
+            if (gen() % 2 == 0) {
+                rhs.score = lhs.score;
+                rhs.tag = lhs.tag;
+            }
+        }
+        int expect = tuple_cmp(lhs, rhs);
+        string lhs_key = encode(lhs);
+        string rhs_key = encode(rhs);
+        int res = cmp<string>(lhs_key, rhs_key);
+        CHECK(((res > 0) - (res < 0)) == expect);
+        // The head integer never contradicts the key order.
+        KeyEncoder lhs_enc;
+        KeyEncoder rhs_enc;
+        lhs_enc.append_string(lhs.name);
+        rhs_enc.append_string(rhs.name);
+        CHECK(lhs_enc.to_uint64() <= rhs_enc.to_uint64() || string_sign(lhs.name, rhs.name) > 0);
+        CHECK(lhs_enc.to_uint128() <= rhs_enc.to_uint128() || string_sign(lhs.name, rhs.name) > 0);
+    }
+}
+
+static void test_round_trip() {
+    std::mt19937_64 gen(29);
+    for (int i = 0; i < 20000; ++i) {
+        Tuple tuple = make_tuple(gen);
+        Tuple back;
+        CHECK(decode(encode(tuple), &back) == 0);
+        CHECK(back.name == tuple.name && back.time == tuple.time && back.tag == tuple.tag);
+        CHECK(back.level == tuple.level && back.id == tuple.id && back.flags == tuple.flags);
+        // -0.0 comes back as 0.0.
+        CHECK(same_float(back.score, (tuple.score == 0) ? 0.0 : tuple.score));
+        CHECK(same_float(back.weight, (tuple.weight == 0) ? 0.0f : tuple.weight));
+    }
+}
+
+/**
+ * Every strict prefix of a key fails, so does a bad escape.
+ */
+static void test_truncated() {
+    std::mt19937_64 gen(30);
+    for (int i = 0; i < 2000; ++i) {
+        string key = encode(make_tuple(gen));
+        Tuple back;
+        for (size_t size = 0; size < key.size(); ++size) {
+            CHECK(decode(key.substr(0, size), &back) == -1);
+        }
+        CHECK(decode(key + "x", &back) == -1);
+    }
+    string str;
+    CHECK(KeyDecoder(string("a\0\x05", 3)).read_string(&str) == -1);
+    CHECK(KeyDecoder(string("a\0", 2)).read_string(&str) == -1);
+    CHECK(KeyDecoder(string("a\0\x01", 3)).read_string(&str) == 0 && str == "a");
+    uint64_t val = 0;
+    CHECK(KeyDecoder(string(7, 'x')).read_uint64(&val) == -1);
+}
+
+int main() {
+    test_order();
+    test_round_trip();
+    test_truncated();
+    return TEST_RESULT();
+}
@@ -0,0 +1,135 @@
+/**
+ * Tests of MappedFile and LineReader over files, pipes and FIFOs.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "linereader.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+static void write_all(int fd, const string& data) {
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n <= 0) {
+            return;
+        }
+        done += n;
+    }
+}
+
+static vector<string> read_lines(LineReader* reader) {
+    vector<string> res;
+    StrView line;
+    while (reader->next(&line) == 0) {
+        res.push_back(line.str());
+    }
+    return res;
+}
+
+static void test_file() {
+    const string path = "/tmp/wttool_test_linereader.txt";
+    FILE* file = fopen(path.c_str(), "w");
+    fputs("a\r\n\nbc\nlast", file);
+    fclose(file);
+    LineReader reader;
+    CHECK(reader.open(path) == 0);
+    vector<string> lines = read_lines(&reader);
+    CHECK(lines.size() == 4);
+    CHECK(lines.size() == 4 && lines[0] == "a" && lines[1] == "" && lines[2] == "bc" && lines[3] == "last");
+    reader.close();
+    unlink(path.c_str());
+    CHECK(reader.open(path) == -1);
+}
+
+/**
+ * Lines of a writer still holding the pipe come out at once.
+ */
+static void test_live_pipe() {
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    LineReader reader;
+    CHECK(reader.open_fd(fds[0]) == 0);
+    StrView line;
+    write_all(fds[1], "a\nb\n");
+    CHECK(reader.next(&line) == 0 && line.str() == "a");
+    CHECK(reader.next(&line) == 0 && line.str() == "b");
+    write_all(fds[1], "c");
+    std::thread writer([&]() {
+        usleep(20000);
+        write_all(fds[1], "d\n");
+    });
+    CHECK(reader.next(&line) == 0 && line.str() == "cd");
+    writer.join();
+    // close() does not wait for the writer.
+    reader.close();
+    close(fds[0]);
+    close(fds[1]);
+}
+
+/**
+ * Lines longer than a block, from a fast writer.
+ */
+static void test_long_lines() {
+    int fds[2];
+    CHECK(pipe(fds) == 0);
+    vector<string> expect;
+    for (int i = 0; i < 200; ++i) {
+        expect.push_back(string(i * 97 % 9000, 'a' + i % 26));
+    }
+    std::thread writer([&]() {
+        for (size_t i = 0; i < expect.size(); ++i) {
+            write_all(fds[1], expect[i] + "\n");
+        }
+        close(fds[1]);
+    });
+    LineReader reader(4096);
+    CHECK(reader.open_fd(fds[0]) == 0);
+    CHECK(read_lines(&reader) == expect);
+    writer.join();
+    reader.close();
+    close(fds[0]);
+}
+
+/**
+ * The FIFO is opened once, so nothing written before the reader starts is lost.
+ */
+static void test_fifo() {
+    const string path = "/tmp/wttool_test_linereader.fifo";
+    unlink(path.c_str());
+    CHECK(mkfifo(path.c_str(), 0600) == 0);
+    std::thread writer([&]() {
+        int fd = open(path.c_str(), O_WRONLY);
+        write_all(fd, "1\n2\n3\n");
+        close(fd);
+    });
+    LineReader reader;
+    CHECK(reader.open(path) == 0);
+    vector<string> lines = read_lines(&reader);
+    CHECK(lines.size() == 3 && lines[0] == "1" && lines[2] == "3");
+    writer.join();
+    reader.close();
+    unlink(path.c_str());
+}
+
+int main() {
+    // A hang is a failure.
+    alarm(20);
+    test_file();
+    test_live_pipe();
+    test_long_lines();
+    test_fifo();
+    return TEST_RESULT();
+}
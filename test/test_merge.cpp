@@ -0,0 +1,236 @@
+/**
+ * Tests of LoserTree, the sources, kmerge, kmerge_corank and kmerge_parallel
+ * against std::stable_sort of the concatenated arrays.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <list>
+#include <random>
+#include <vector>
+
+#include "merge.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+// Compared by key only, source and index tell equal records apart.
+struct Record {
+    int32_t key;
+    int32_t source;
+    int32_t index;
+};
+
+static int64_t g_compares = 0;
+
+static int record_cmp(const Record& lhs, const Record& rhs) {
+    ++g_compares;
+    if (lhs.key != rhs.key) {
+        return (lhs.key < rhs.key) ? -1 : 1;
+    }
+    return 0;
+}
+
+static bool record_less(const Record& lhs, const Record& rhs) {
+    return lhs.key < rhs.key;
+}
+
+static bool same(const vector<Record>& lhs, const vector<Record>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (lhs[i].key != rhs[i].key || lhs[i].source != rhs[i].source || lhs[i].index != rhs[i].index) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * k sorted arrays with many equal keys, some of them empty.
+ */
+static vector<vector<Record> > make_arrays(std::mt19937& gen, int64_t k, int64_t max_length, int32_t keys) {
+    vector<vector<Record> > arrays(k);
+    for (int64_t i = 0; i < k; ++i) {
+        int64_t length = (gen() % 5 == 0) ? 0 : gen() % (max_length + 1);
+        for (int64_t j = 0; j < length; ++j) {
+            Record record;
+            record.key = gen() % keys;
+            record.source = i;
+            arrays[i].push_back(record);
+        }
+        std::sort(arrays[i].begin(), arrays[i].end(), record_less);
+        for (size_t j = 0; j < arrays[i].size(); ++j) {
+            arrays[i][j].index = j;
+        }
+    }
+    return arrays;
+}
+
+/**
+ * The stable merge is the stable sort of the arrays joined in source order.
+ */
+static vector<Record> expect_merge(const vector<vector<Record> >& arrays) {
+    vector<Record> res;
+    for (size_t i = 0; i < arrays.size(); ++i) {
+        res.insert(res.end(), arrays[i].begin(), arrays[i].end());
+    }
+    std::stable_sort(res.begin(), res.end(), record_less);
+    return res;
+}
+
+static void pointers(const vector<vector<Record> >& arrays, vector<const Record*>* seqs, vector<int64_t>* lengths) {
+    seqs->clear();
+    lengths->clear();
+    for (size_t i = 0; i < arrays.size(); ++i) {
+        seqs->push_back(arrays[i].data());
+        lengths->push_back(arrays[i].size());
+    }
+}
+
+static void test_loser_tree() {
+    std::mt19937 gen(30);
+    // No source and one source.
+    LoserTree<int64_t> empty;
+    CHECK(empty.init() == 0);
+    CHECK(empty.top() == nullptr && empty.top_source() == -1 && empty.pop() == -1);
+    vector<int64_t> one_data(5);
+    for (int64_t i = 0; i < 5; ++i) {
+        one_data[i] = i * 3;
+    }
+    ArraySource<int64_t> one_source(one_data.data(), one_data.size());
+    LoserTree<int64_t> one;
+    CHECK(one.add_source(&one_source) == 0);
+    CHECK(one.init() == 0);
+    CHECK(one.add_source(&one_source) == -1 && one.init() == -1);
+    int64_t val = 0;
+    for (int64_t i = 0; i < 5; ++i) {
+        CHECK(one.top_source() == 0);
+        CHECK(one.next(&val) == 0 && val == i * 3);
+    }
+    CHECK(one.next(&val) == -1);
+
+    // Sources over lists, refilled block by block.
+    for (int64_t k = 1; k <= 9; ++k) {
+        vector<vector<Record> > arrays = make_arrays(gen, k, 3 * MERGE_SOURCE_BLOCK, 50);
+        vector<list<Record> > lists(k);
+        typedef IterSource<Record, list<Record>::const_iterator> ListSource;
+        vector<ListSource> sources;
+        sources.reserve(k);
+        LoserTree<Record> tree(record_cmp);
+        for (int64_t i = 0; i < k; ++i) {
+            lists[i].assign(arrays[i].begin(), arrays[i].end());
+            sources.push_back(ListSource(lists[i].begin(), lists[i].end()));
+        }
+        for (int64_t i = 0; i < k; ++i) {
+            tree.add_source(&sources[i]);
+        }
+        tree.init();
+        vector<Record> out;
+        Record record;
+        while (tree.top() != nullptr) {
+            CHECK(tree.top_source() == tree.top()->source);
+            CHECK(tree.next(&record) == 0);
+            out.push_back(record);
+        }
+        CHECK(same(out, expect_merge(arrays)));
+    }
+}
+
+static void test_kmerge() {
+    std::mt19937 gen(31);
+    vector<const Record*> seqs;
+    vector<int64_t> lengths;
+    vector<Record> out(1);
+    CHECK(kmerge<Record>(nullptr, nullptr, 0, out.data(), record_cmp) == 0);
+    for (int round = 0; round < 100; ++round) {
+        int64_t k = (round < 10) ? 1 : gen() % 40 + 1;
+        vector<vector<Record> > arrays = make_arrays(gen, k, 300, (round % 2 == 0) ? 5 : 100000);
+        pointers(arrays, &seqs, &lengths);
+        vector<Record> expect = expect_merge(arrays);
+        out.assign(expect.size(), Record());
+        CHECK(kmerge(seqs.data(), lengths.data(), k, out.data(), record_cmp) == (int64_t)expect.size());
+        CHECK(same(out, expect));
+    }
+}
+
+/**
+ * Every rank gives the split of the stable merge, and a rank costs about
+ * O(k * log(n)^2) comparisons, not O(k^2).
+ */
+static void test_corank() {
+    std::mt19937 gen(32);
+    vector<const Record*> seqs;
+    vector<int64_t> lengths;
+    for (int round = 0; round < 40; ++round) {
+        int64_t k = (round < 5) ? 1 : gen() % 12 + 1;
+        vector<vector<Record> > arrays = make_arrays(gen, k, 60, (round % 2 == 0) ? 3 : 1000);
+        pointers(arrays, &seqs, &lengths);
+        vector<Record> expect = expect_merge(arrays);
+        vector<int64_t> pos(k);
+        vector<int64_t> counts(k, 0);
+        for (size_t rank = 0; rank <= expect.size(); ++rank) {
+            kmerge_corank(seqs.data(), lengths.data(), k, rank, pos.data(), record_cmp);
+            CHECK(pos == counts);
+            if (rank < expect.size()) {
+                ++counts[expect[rank].source];
+            }
+        }
+    }
+    const int64_t k = 512;
+    vector<vector<Record> > arrays = make_arrays(gen, k, 2000, 1 << 30);
+    pointers(arrays, &seqs, &lengths);
+    int64_t total = expect_merge(arrays).size();
+    vector<int64_t> pos(k);
+    g_compares = 0;
+    kmerge_corank(seqs.data(), lengths.data(), k, total / 3, pos.data(), record_cmp);
+    CHECK(g_compares < 64 * k * 11 * 2);
+    int64_t sum = 0;
+    for (int64_t i = 0; i < k; ++i) {
+        sum += pos[i];
+    }
+    CHECK(sum == total / 3);
+}
+
+static void test_kmerge_parallel() {
+    std::mt19937 gen(33);
+    vector<const Record*> seqs;
+    vector<int64_t> lengths;
+    for (int round = 0; round < 30; ++round) {
+        int64_t k = (round < 3) ? round : gen() % 200 + 1;
+        int threads = (round % 5) + 1;
+        vector<vector<Record> > arrays = make_arrays(gen, k, 400, (round % 2 == 0) ? 4 : 1000000);
+        pointers(arrays, &seqs, &lengths);
+        vector<Record> expect = expect_merge(arrays);
+        vector<Record> out(expect.size() + 1);
+        CHECK(kmerge_parallel(seqs.data(), lengths.data(), k, out.data(), threads, record_cmp) ==
+              (int64_t)expect.size());
+        out.resize(expect.size());
+        CHECK(same(out, expect));
+    }
+    // The default comparator.
+    vector<int64_t> a(1000);
+    vector<int64_t> b(1000);
+    for (int64_t i = 0; i < 1000; ++i) {
+        a[i] = i * 2;
+        b[i] = i * 2 + 1;
+    }
+    const int64_t* seqs_2[2] = {a.data(), b.data()};
+    int64_t lengths_2[2] = {1000, 1000};
+    vector<int64_t> out(2000);
+    CHECK(kmerge_parallel(seqs_2, lengths_2, 2, out.data(), 4) == 2000);
+    for (int64_t i = 0; i < 2000; ++i) {
+        CHECK(out[i] == i);
+    }
+}
+
+int main() {
+    test_loser_tree();
+    test_kmerge();
+    test_corank();
+    test_kmerge_parallel();
+    return TEST_RESULT();
+}
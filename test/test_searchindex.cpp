@@ -0,0 +1,144 @@
+/**
+ * Tests of EytzingerIndex and BTreeIndex against std::lower_bound and
+ * std::upper_bound, with the default and custom comparators.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "searchindex.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+struct Event {
+    int64_t time;
+    int32_t source;
+};
+
+// Descending by time, then ascending by source.
+static int event_cmp(const Event& lhs, const Event& rhs) {
+    if (lhs.time != rhs.time) {
+        return (lhs.time > rhs.time) ? -1 : 1;
+    }
+    if (lhs.source != rhs.source) {
+        return (lhs.source < rhs.source) ? -1 : 1;
+    }
+    return 0;
+}
+
+template <typename T, typename Index>
+static void check_index(const vector<T>& data, const vector<T>& keys,
+                        int (*compare)(const T& lhs, const T& rhs)) {
+    auto less = [compare](const T& lhs, const T& rhs) { return compare(lhs, rhs) < 0; };
+    Index index;
+    CHECK(index.build(data.data(), data.size()) == 0);
+    CHECK(index.size() == (int64_t)data.size());
+    vector<int64_t> lower(keys.size());
+    vector<int64_t> upper(keys.size());
+    index.lower_bound_batch(keys.data(), keys.size(), lower.data());
+    index.upper_bound_batch(keys.data(), keys.size(), upper.data());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        int64_t expect_lower = std::lower_bound(data.begin(), data.end(), keys[i], less) - data.begin();
+        int64_t expect_upper = std::upper_bound(data.begin(), data.end(), keys[i], less) - data.begin();
+        CHECK(index.lower_bound(keys[i]) == expect_lower);
+        CHECK(index.upper_bound(keys[i]) == expect_upper);
+        CHECK(lower[i] == expect_lower && upper[i] == expect_upper);
+    }
+}
+
+template <typename T>
+static void check_all(vector<T> data, const vector<T>& keys, int (*compare)(const T& lhs, const T& rhs)) {
+    std::sort(data.begin(), data.end(), [compare](const T& lhs, const T& rhs) {
+        return compare(lhs, rhs) < 0;
+    });
+    check_index<T, EytzingerIndex<T> >(data, keys, compare);
+    check_index<T, BTreeIndex<T> >(data, keys, compare);
+    check_index<T, BTreeIndex<T, 3> >(data, keys, compare);
+}
+
+static void test_int32() {
+    std::mt19937 gen(1);
+    for (int64_t n = 0; n < 300; n += 1 + n / 4) {
+        vector<int32_t> data(n);
+        vector<int32_t> keys(200);
+        for (int64_t i = 0; i < n; ++i) {
+            data[i] = gen() % 100;
+        }
+        for (size_t i = 0; i < keys.size(); ++i) {
+            keys[i] = (int32_t)(gen() % 110) - 5;
+        }
+        check_all(data, keys, cmp<int32_t>);
+    }
+}
+
+static void test_double() {
+    std::mt19937 gen(2);
+    vector<double> data(1000);
+    vector<double> keys(500);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (gen() % 200) / 4.0 - 10;
+    }
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = (gen() % 250) / 4.0 - 20;
+    }
+    check_all(data, keys, cmp<double>);
+    vector<double> sorted = data;
+    std::sort(sorted.begin(), sorted.end());
+    EytzingerIndex<double> index;
+    index.build(sorted.data(), sorted.size());
+    CHECK(index.lower_bound(-1e9) == 0 && index.lower_bound(1e9) == (int64_t)sorted.size());
+}
+
+static void test_struct() {
+    std::mt19937 gen(3);
+    vector<Event> data(700);
+    vector<Event> keys(300);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i].time = gen() % 50;
+        data[i].source = gen() % 5;
+    }
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i].time = (int64_t)(gen() % 60) - 5;
+        keys[i].source = gen() % 7;
+    }
+    std::sort(data.begin(), data.end(), [](const Event& lhs, const Event& rhs) {
+        return event_cmp(lhs, rhs) < 0;
+    });
+    check_index<Event, EytzingerIndex<Event, event_cmp> >(data, keys, event_cmp);
+    check_index<Event, BTreeIndex<Event, 8, event_cmp> >(data, keys, event_cmp);
+}
+
+/**
+ * Every size up to a few levels, so each shape of the last level is hit by
+ * the positions computed from node indexes.
+ */
+static void test_sizes() {
+    for (int64_t n = 0; n < 700; ++n) {
+        vector<int32_t> data(n);
+        vector<int32_t> keys(2 * n + 2);
+        for (int64_t i = 0; i < n; ++i) {
+            data[i] = 2 * i;
+        }
+        for (size_t i = 0; i < keys.size(); ++i) {
+            keys[i] = (int32_t)i - 1;
+        }
+        check_index<int32_t, EytzingerIndex<int32_t> >(data, keys, cmp<int32_t>);
+        check_index<int32_t, BTreeIndex<int32_t, 1> >(data, keys, cmp<int32_t>);
+        check_index<int32_t, BTreeIndex<int32_t, 2> >(data, keys, cmp<int32_t>);
+        check_index<int32_t, BTreeIndex<int32_t, 5> >(data, keys, cmp<int32_t>);
+        check_index<int32_t, BTreeIndex<int32_t> >(data, keys, cmp<int32_t>);
+    }
+}
+
+int main() {
+    test_sizes();
+    test_int32();
+    test_double();
+    test_struct();
+    return TEST_RESULT();
+}
@@ -0,0 +1,152 @@
+/**
+ * Tests of the sorted set operations against std::set_intersection,
+ * std::set_union and std::set_difference, for uint32_t and uint64_t.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "setop.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+/**
+ * A sorted set of n elements below range, so a small range means overlap.
+ */
+template <typename T>
+static vector<T> make_set(std::mt19937_64& gen, int64_t n, uint64_t range) {
+    vector<T> res(n);
+    for (int64_t i = 0; i < n; ++i) {
+        res[i] = (T)(gen() % range);
+    }
+    std::sort(res.begin(), res.end());
+    res.erase(std::unique(res.begin(), res.end()), res.end());
+    return res;
+}
+
+template <typename T>
+static void check_pair(const vector<T>& a, const vector<T>& b) {
+    vector<T> expect;
+    vector<T> out(a.size() + b.size() + 1);
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expect));
+    int64_t n = intersect_sorted(a.data(), a.size(), b.data(), b.size(), out.data());
+    CHECK(vector<T>(out.begin(), out.begin() + n) == expect);
+    n = _intersect_block(a.data(), a.size(), b.data(), b.size(), out.data());
+    CHECK(vector<T>(out.begin(), out.begin() + n) == expect);
+
+    expect.clear();
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expect));
+    n = union_sorted(a.data(), a.size(), b.data(), b.size(), out.data());
+    CHECK(vector<T>(out.begin(), out.begin() + n) == expect);
+
+    expect.clear();
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(expect));
+    n = difference_sorted(a.data(), a.size(), b.data(), b.size(), out.data());
+    CHECK(vector<T>(out.begin(), out.begin() + n) == expect);
+    n = _difference_block(a.data(), a.size(), b.data(), b.size(), out.data());
+    CHECK(vector<T>(out.begin(), out.begin() + n) == expect);
+}
+
+/**
+ * Size ratios on both sides of SETOP_GALLOP_RATIO, dense and sparse overlap.
+ */
+template <typename T>
+static void test_pairs(uint64_t seed) {
+    std::mt19937_64 gen(seed);
+    const int64_t ratios[] = {1, 2, 7, SETOP_GALLOP_RATIO - 1, SETOP_GALLOP_RATIO, SETOP_GALLOP_RATIO + 1, 200};
+    for (size_t r = 0; r < sizeof(ratios) / sizeof(ratios[0]); ++r) {
+        for (int round = 0; round < 30; ++round) {
+            int64_t small = gen() % 40;
+            int64_t big = small * ratios[r] + gen() % 4;
+            uint64_t range = (round % 3 == 0) ? (uint64_t)big * 2 + 8 : ((round % 3 == 1) ? 1000000 : ~(uint64_t)0);
+            vector<T> a = make_set<T>(gen, small, range);
+            vector<T> b = make_set<T>(gen, big, range);
+            check_pair(a, b);
+            check_pair(b, a);
+        }
+    }
+    vector<T> empty;
+    vector<T> some = make_set<T>(gen, 100, 300);
+    check_pair(empty, some);
+    check_pair(some, empty);
+    check_pair(some, some);
+}
+
+/**
+ * An a block spanning several b blocks, matched in an early b block and
+ * then cut by the end of the b blocks, so the carried mask is used.
+ */
+static void test_carried_mask() {
+    std::mt19937_64 gen(31);
+    for (int round = 0; round < 2000; ++round) {
+        // b is dense in a small range, a is sparse over it.
+        vector<uint32_t> b = make_set<uint32_t>(gen, 8 + gen() % 40, 64);
+        vector<uint32_t> a = make_set<uint32_t>(gen, 4 + gen() % 8, 80);
+        check_pair(a, b);
+        check_pair(b, a);
+    }
+    const uint32_t a[] = {1, 20, 40, 60, 61};
+    const uint32_t b[] = {1, 2, 3, 4, 5, 6, 7, 8, 40, 41};
+    uint32_t out[5];
+    CHECK(_difference_block(a, 5, b, 10, out) == 3);
+    CHECK(out[0] == 20 && out[1] == 60 && out[2] == 61);
+    CHECK(_intersect_block(a, 5, b, 10, out) == 2);
+    CHECK(out[0] == 1 && out[1] == 40);
+}
+
+static void test_unique() {
+    std::mt19937_64 gen(32);
+    for (int64_t n = 0; n < 300; n += 7) {
+        vector<uint64_t> data(n);
+        for (int64_t i = 0; i < n; ++i) {
+            data[i] = gen() % 20;
+        }
+        std::sort(data.begin(), data.end());
+        vector<uint64_t> expect = data;
+        expect.erase(std::unique(expect.begin(), expect.end()), expect.end());
+        // In place.
+        int64_t count = unique_sorted(data.data(), n, data.data());
+        CHECK(vector<uint64_t>(data.begin(), data.begin() + count) == expect);
+    }
+}
+
+static void test_intersect_k() {
+    std::mt19937_64 gen(33);
+    vector<uint32_t> out(5000);
+    CHECK(intersect_sorted((const uint32_t* const*)nullptr, nullptr, 0, out.data()) == 0);
+    for (int round = 0; round < 200; ++round) {
+        int64_t k = 1 + gen() % 6;
+        vector<vector<uint32_t> > sets(k);
+        vector<const uint32_t*> seqs(k);
+        vector<int64_t> lengths(k);
+        for (int64_t i = 0; i < k; ++i) {
+            sets[i] = make_set<uint32_t>(gen, gen() % 4000, 5000);
+            seqs[i] = sets[i].data();
+            lengths[i] = sets[i].size();
+        }
+        vector<uint32_t> expect = sets[0];
+        for (int64_t i = 1; i < k; ++i) {
+            vector<uint32_t> next;
+            std::set_intersection(expect.begin(), expect.end(), sets[i].begin(), sets[i].end(),
+                                  std::back_inserter(next));
+            expect.swap(next);
+        }
+        int64_t count = intersect_sorted(seqs.data(), lengths.data(), k, out.data());
+        CHECK(vector<uint32_t>(out.begin(), out.begin() + count) == expect);
+    }
+}
+
+int main() {
+    test_pairs<uint32_t>(31);
+    test_pairs<uint64_t>(64);
+    test_carried_mask();
+    test_unique();
+    test_intersect_k();
+    return TEST_RESULT();
+}
@@ -0,0 +1,271 @@
+/**
+ * Tests of tsort, msort, isort, ssort, qsort and Heap against the std sorts.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sort.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+// Allocations of the whole program, to check a sort allocates nothing.
+static int64_t g_allocs = 0;
+
+void* operator new(size_t size) {
+    ++g_allocs;
+    void* res = malloc(size == 0 ? 1 : size);
+    if (res == nullptr) {
+        throw std::bad_alloc();
+    }
+    return res;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+// Compared by key only, index tells equal records apart.
+struct Record {
+    int32_t key;
+    int32_t index;
+};
+
+static int64_t g_compares = 0;
+
+static int record_cmp(const Record& lhs, const Record& rhs) {
+    ++g_compares;
+    if (lhs.key != rhs.key) {
+        return (lhs.key < rhs.key) ? -1 : 1;
+    }
+    return 0;
+}
+
+static bool record_less(const Record& lhs, const Record& rhs) {
+    return lhs.key < rhs.key;
+}
+
+static int desc_cmp(const int64_t& lhs, const int64_t& rhs) {
+    if (lhs != rhs) {
+        return (lhs > rhs) ? -1 : 1;
+    }
+    return 0;
+}
+
+static bool same(const vector<Record>& lhs, const vector<Record>& rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        if (lhs[i].key != rhs[i].key || lhs[i].index != rhs[i].index) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static vector<Record> make_records(const vector<int32_t>& keys) {
+    vector<Record> res(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+        res[i].key = keys[i];
+        res[i].index = i;
+    }
+    return res;
+}
+
+/**
+ * The shapes of input: random with many equal keys, sorted runs, runs with
+ * a few elements out of place, and blocks which make the merges gallop.
+ */
+static vector<int32_t> make_keys(std::mt19937& gen, int64_t n, int shape) {
+    vector<int32_t> keys(n);
+    for (int64_t i = 0; i < n; ++i) {
+        keys[i] = gen() % ((shape == 0) ? 8 : 1000000);
+    }
+    if (shape == 1) {
+        std::sort(keys.begin(), keys.end());
+        for (int64_t i = 0; i < n / 20; ++i) {
+            std::swap(keys[gen() % n], keys[gen() % n]);
+        }
+    } else if (shape == 2) {
+        // Sorted runs of random length, half of them descending.
+        for (int64_t s = 0; s < n;) {
+            int64_t e = std::min<int64_t>(n, s + 1 + gen() % 300);
+            std::sort(keys.begin() + s, keys.begin() + e);
+            if (gen() % 2 == 0) {
+                std::reverse(keys.begin() + s, keys.begin() + e);
+            }
+            s = e;
+        }
+    } else if (shape == 3) {
+        // Interleaved blocks of two sorted halves.
+        for (int64_t i = 0; i < n; ++i) {
+            keys[i] = (i < n / 2) ? (i / 50) * 100 + i % 50 : ((i - n / 2) / 50) * 100 + 50 + i % 50;
+        }
+    }
+    return keys;
+}
+
+static void test_tsort_stable() {
+    std::mt19937 gen(29);
+    const int64_t sizes[] = {0, 1, 2, 3, TSORT_MIN_RUN - 1, TSORT_MIN_RUN, TSORT_MIN_RUN + 1,
+                             2 * TSORT_MIN_RUN - 1, 2 * TSORT_MIN_RUN, 2 * TSORT_MIN_RUN + 1,
+                             100, 1000, 4097, 100000};
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+        for (int shape = 0; shape < 4; ++shape) {
+            vector<Record> data = make_records(make_keys(gen, sizes[s], shape));
+            vector<Record> expect = data;
+            std::stable_sort(expect.begin(), expect.end(), record_less);
+            CHECK(tsort(data.data(), data.size(), record_cmp) == 0);
+            CHECK(same(data, expect));
+        }
+    }
+    // Moved, not copied, strings.
+    vector<string> strs(5000);
+    for (size_t i = 0; i < strs.size(); ++i) {
+        strs[i] = std::to_string(gen() % 3000) + string(gen() % 40, 'x');
+    }
+    vector<string> expect = strs;
+    std::stable_sort(expect.begin(), expect.end());
+    tsort(strs.data(), strs.size());
+    CHECK(strs == expect);
+}
+
+/**
+ * Sorted and strictly descending input is one run, n - 1 comparisons and
+ * no buffer. Descending with equal keys is not reversed as a whole.
+ */
+static void test_tsort_presorted() {
+    const int64_t n = 10000;
+    vector<int32_t> keys(n);
+    for (int64_t i = 0; i < n; ++i) {
+        keys[i] = i;
+    }
+    vector<Record> data = make_records(keys);
+    g_compares = 0;
+    int64_t allocs = g_allocs;
+    tsort(data.data(), n, record_cmp);
+    CHECK(g_compares == n - 1);
+    CHECK(g_allocs == allocs);
+
+    std::reverse(keys.begin(), keys.end());
+    data = make_records(keys);
+    g_compares = 0;
+    allocs = g_allocs;
+    tsort(data.data(), n, record_cmp);
+    CHECK(g_compares == n - 1);
+    CHECK(g_allocs == allocs);
+    for (int64_t i = 0; i < n; ++i) {
+        CHECK(data[i].key == i);
+    }
+
+    for (int64_t i = 0; i < n; ++i) {
+        keys[i] = (n - i) / 3;
+    }
+    data = make_records(keys);
+    vector<Record> expect = data;
+    std::stable_sort(expect.begin(), expect.end(), record_less);
+    tsort(data.data(), n, record_cmp);
+    CHECK(same(data, expect));
+}
+
+/**
+ * The other sorts take the compare argument, msort and isort are stable.
+ */
+static void test_other_sorts() {
+    std::mt19937 gen(27);
+    for (int64_t n = 0; n < 200; n += 1 + n / 3) {
+        vector<Record> records = make_records(make_keys(gen, n, 0));
+        vector<Record> expect = records;
+        std::stable_sort(expect.begin(), expect.end(), record_less);
+        vector<Record> data = records;
+        msort(data.data(), n, record_cmp);
+        CHECK(same(data, expect));
+        data = records;
+        isort(data.data(), n, record_cmp);
+        CHECK(same(data, expect));
+
+        vector<int64_t> nums(n);
+        for (int64_t i = 0; i < n; ++i) {
+            nums[i] = gen() % 50;
+        }
+        vector<int64_t> desc = nums;
+        std::sort(desc.begin(), desc.end(), [](int64_t lhs, int64_t rhs) { return lhs > rhs; });
+        vector<int64_t> res = nums;
+        ssort(res.data(), n, desc_cmp);
+        CHECK(res == desc);
+        res = nums;
+        msort(res.data(), n, desc_cmp);
+        CHECK(res == desc);
+        res = nums;
+        isort(res.data(), n, desc_cmp);
+        CHECK(res == desc);
+        res = nums;
+        qsort(res.data(), n, desc_cmp);
+        CHECK(res == desc);
+        res = nums;
+        sel_sort(res.data(), n, desc_cmp);
+        CHECK(res == desc);
+    }
+}
+
+static void test_heap() {
+    Heap<int64_t, string> min_heap(true, cmp<int64_t>, 1);
+    CHECK(min_heap.top() == -1 && min_heap.pop() == -1 && min_heap.size() == 0);
+    CHECK(min_heap.push(5, "five") == 0);
+    CHECK(min_heap.push(5, "again") == -1);
+    CHECK(min_heap.push(3, "three") == 0);
+    CHECK(min_heap.push(9, "nine") == 0);
+    int64_t key = 0;
+    string val;
+    CHECK(min_heap.top(&key, &val) == 0 && key == 3 && val == "three");
+    CHECK(min_heap.find(9, &val) == 0 && val == "nine");
+    CHECK(min_heap.find(4) == -1);
+    CHECK(min_heap.erase(3, &val) == 0 && val == "three");
+    CHECK(min_heap.erase(3) == -1);
+    CHECK(min_heap.top(&key) == 0 && key == 5 && min_heap.size() == 2);
+
+    // Random operations against a map, the heap grows from capacity 1.
+    std::mt19937 gen(36);
+    for (int round = 0; round < 2; ++round) {
+        bool min = (round == 0);
+        Heap<int64_t, int64_t> heap(min, cmp<int64_t>, 1);
+        std::map<int64_t, int64_t> expect;
+        for (int i = 0; i < 20000; ++i) {
+            int64_t k = gen() % 500;
+            int op = gen() % 4;
+            if (op < 2) {
+                CHECK(heap.push(k, k * 7) == (expect.count(k) ? -1 : 0));
+                expect.insert(std::make_pair(k, k * 7));
+            } else if (op == 2) {
+                int64_t v = 0;
+                CHECK(heap.erase(k, &v) == (expect.count(k) ? 0 : -1));
+                CHECK(!expect.count(k) || v == k * 7);
+                expect.erase(k);
+            } else if (!expect.empty()) {
+                int64_t top = min ? expect.begin()->first : expect.rbegin()->first;
+                CHECK(heap.top(&key) == 0 && key == top);
+                CHECK(heap.pop() == 0);
+                expect.erase(top);
+            }
+            CHECK(heap.size() == (int64_t)expect.size());
+        }
+    }
+}
+
+int main() {
+    test_tsort_stable();
+    test_tsort_presorted();
+    test_other_sorts();
+    test_heap();
+    return TEST_RESULT();
+}
@@ -0,0 +1,315 @@
+/**
+ * Tests of SortServer and SortClient over a socketpair and a socket path.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <dirent.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sortserver.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+static vector<string> make_records(std::mt19937& gen, size_t count) {
+    vector<string> res(count);
+    for (size_t i = 0; i < count; ++i) {
+        res[i].resize(gen() % 24);
+        for (size_t j = 0; j < res[i].size(); ++j) {
+            // Few distinct bytes give many equal records and shared prefixes.
+            res[i][j] = (gen() % 8 == 0) ? '\0' : (char)('a' + gen() % 4);
+        }
+    }
+    return res;
+}
+
+/**
+ * Send batches, inline and by memfd in turn, and check the merged output.
+ * @param declare: Declare the job size first.
+ * @return 0 means the output is the sorted input.
+ */
+static int round_trip(SortClient* client, std::mt19937& gen, int batches, bool declare) {
+    vector<vector<string> > jobs(batches);
+    vector<string> all;
+    uint64_t bytes = 0;
+    for (int i = 0; i < batches; ++i) {
+        jobs[i] = make_records(gen, gen() % 2000);
+        for (size_t j = 0; j < jobs[i].size(); ++j) {
+            bytes += jobs[i][j].size();
+        }
+        all.insert(all.end(), jobs[i].begin(), jobs[i].end());
+    }
+    if (declare && client->begin(bytes, all.size()) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < batches; ++i) {
+        int res = (i % 2 == 0) ? client->send_batch(jobs[i]) : client->send_batch_memfd(jobs[i]);
+        if (res != 0) {
+            return -1;
+        }
+    }
+    if (client->finish() != 0) {
+        return -1;
+    }
+    vector<string> out;
+    if (client->read_all(&out) != 0) {
+        return -1;
+    }
+    std::sort(all.begin(), all.end());
+    return (out == all) ? 0 : -1;
+}
+
+static void test_socketpair() {
+    SortServer server(2, 16 << 20, 1000);
+    int fds[2];
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    std::thread serving([&]() {
+        CHECK(server.serve_fd(fds[0]) == 0);
+    });
+    std::mt19937 gen(36);
+    SortClient client;
+    client.attach(fds[1]);
+    // Several jobs on one connection, the second one declared.
+    for (int i = 0; i < 3; ++i) {
+        CHECK(round_trip(&client, gen, 9, i == 1) == 0);
+    }
+    CHECK(client.finish() == 0);
+    vector<string> out;
+    CHECK(client.read_all(&out) == 0 && out.empty());
+    client.close();
+    serving.join();
+    CHECK(server.memory_used() == 0);
+}
+
+/**
+ * A memfd without seals could be shrunk under the mapping, it is refused.
+ */
+static void test_unsealed_memfd() {
+    SortServer server(1, 16 << 20, 1000);
+    int fds[2];
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    std::thread serving([&]() {
+        server.serve_fd(fds[0]);
+    });
+    int memfd = memfd_create("test_unsealed", MFD_CLOEXEC);
+    uint32_t size = 1;
+    char record[5];
+    memcpy(record, &size, sizeof(size));
+    record[4] = 'x';
+    CHECK(write(memfd, record, sizeof(record)) == (ssize_t)sizeof(record));
+    SortFrameHeader header;
+    header.type = SORT_FRAME_BATCH_FD;
+    header.count = 1;
+    header.length = sizeof(record);
+    struct iovec iov;
+    iov.iov_base = &header;
+    iov.iov_len = sizeof(header);
+    CHECK(_sortserver_send(fds[1], &iov, 1, memfd) == 0);
+    close(memfd);
+    SortClient client;
+    client.attach(fds[1]);
+    StrView line;
+    CHECK(client.next(&line) == -1);
+    CHECK(client.error() == "The memfd is not sealed.");
+    client.close();
+    serving.join();
+}
+
+static int count_fds() {
+    int count = 0;
+    DIR* dir = opendir("/proc/self/fd");
+    while (dir != nullptr && readdir(dir) != nullptr) {
+        ++count;
+    }
+    if (dir != nullptr) {
+        closedir(dir);
+    }
+    return count;
+}
+
+/**
+ * An fd passed with an inline batch is closed by the server, not leaked.
+ */
+static void test_stray_fd() {
+    SortServer server(1, 16 << 20, 1000);
+    int fds[2];
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    std::thread serving([&]() {
+        server.serve_fd(fds[0]);
+    });
+    int before = count_fds();
+    for (int i = 0; i < 10; ++i) {
+        int stray = memfd_create("test_stray", MFD_CLOEXEC);
+        uint32_t size = 1;
+        char record[5];
+        memcpy(record, &size, sizeof(size));
+        record[4] = 'a' + i;
+        SortFrameHeader header;
+        header.type = SORT_FRAME_BATCH;
+        header.count = 1;
+        header.length = sizeof(record);
+        struct iovec iov[2];
+        iov[0].iov_base = &header;
+        iov[0].iov_len = sizeof(header);
+        iov[1].iov_base = record;
+        iov[1].iov_len = sizeof(record);
+        CHECK(_sortserver_send(fds[1], iov, 2, stray) == 0);
+        close(stray);
+    }
+    SortClient client;
+    client.attach(fds[1]);
+    CHECK(client.finish() == 0);
+    vector<string> out;
+    CHECK(client.read_all(&out) == 0 && out.size() == 10);
+    CHECK(count_fds() == before);
+    client.close();
+    serving.join();
+}
+
+/**
+ * Concurrent declared jobs over a socket path need more than the budget
+ * together, they wait for memory instead of failing.
+ */
+static void test_socket_path() {
+    const string path = "/tmp/wttool_test_sortserver.sock";
+    SortServer server(4, 1 << 20, 5000);
+    CHECK(server.start(path) == 0);
+    std::atomic<int> failures(0);
+    vector<std::thread> clients;
+    for (int t = 0; t < 6; ++t) {
+        clients.push_back(std::thread([&, t]() {
+            std::mt19937 gen(t);
+            SortClient client;
+            if (client.connect(path) != 0) {
+                ++failures;
+                return;
+            }
+            for (int i = 0; i < 3; ++i) {
+                if (round_trip(&client, gen, 6, true) != 0) {
+                    ++failures;
+                }
+            }
+        }));
+    }
+    for (size_t i = 0; i < clients.size(); ++i) {
+        clients[i].join();
+    }
+    CHECK(failures.load() == 0);
+
+    // A batch over the whole budget fails at once.
+    SortClient client;
+    CHECK(client.connect(path) == 0);
+    vector<string> big(1, string(2 << 20, 'x'));
+    client.send_batch(big);
+    StrView line;
+    CHECK(client.next(&line) == -1);
+    CHECK(client.error() == "Out of the memory budget.");
+    client.close();
+    server.stop();
+    CHECK(server.memory_used() == 0);
+}
+
+/**
+ * Two jobs of 4 batches, each fitting the budget alone but not both together.
+ * Both send 2 batches, then the other 2.
+ * @return The jobs done.
+ */
+static int two_jobs(const string& path, bool declare, int64_t* elapsed_ms) {
+    const size_t records = 1000;
+    vector<string> batch(records, string(196, 'r'));
+    SortServer server(2, 1 << 20, 5000);
+    server.start(path);
+    std::atomic<int> done(0);
+    std::atomic<int> sent(0);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    vector<std::thread> clients;
+    for (int t = 0; t < 2; ++t) {
+        clients.push_back(std::thread([&, t]() {
+            SortClient client;
+            client.connect(path);
+            if (declare) {
+                client.begin(4 * records * 196, 4 * records);
+            }
+            for (int i = 0; i < 4; ++i) {
+                if (i == 2 && !declare) {
+                    // Both jobs hold 2 batches before asking for more.
+                    ++sent;
+                    while (sent.load() < 2 || server.memory_used() < 4 * (records * 200 + records * sizeof(StrView))) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+                }
+                client.send_batch(batch);
+            }
+            client.finish();
+            vector<string> out;
+            if (client.read_all(&out) == 0 && out.size() == 4 * records) {
+                ++done;
+            }
+        }));
+    }
+    for (size_t i = 0; i < clients.size(); ++i) {
+        clients[i].join();
+    }
+    *elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    server.stop();
+    CHECK(server.memory_used() == 0);
+    return done.load();
+}
+
+/**
+ * Jobs holding memory and waiting for each other do not stall until wait_ms.
+ */
+static void test_budget_deadlock() {
+    const string path = "/tmp/wttool_test_sortserver_budget.sock";
+    int64_t elapsed_ms = 0;
+    // Declared jobs reserve their size up front, the second one waits.
+    CHECK(two_jobs(path, true, &elapsed_ms) == 2);
+    CHECK(elapsed_ms < 2000);
+    // Not declared, the job closing the cycle fails at once.
+    CHECK(two_jobs(path, false, &elapsed_ms) == 1);
+    CHECK(elapsed_ms < 2000);
+
+    // Batches over the declared size fail.
+    SortServer server(1, 1 << 20, 1000);
+    int fds[2];
+    CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    std::thread serving([&]() {
+        server.serve_fd(fds[0]);
+    });
+    SortClient client;
+    client.attach(fds[1]);
+    vector<string> records(10, "abc");
+    CHECK(client.begin(30, 10) == 0);
+    CHECK(client.send_batch(records) == 0);
+    CHECK(client.send_batch(records) == 0);
+    StrView line;
+    CHECK(client.next(&line) == -1);
+    CHECK(client.error() == "The batch is over the declared job size.");
+    client.close();
+    serving.join();
+    CHECK(server.memory_used() == 0);
+}
+
+int main() {
+    // A hang is a failure.
+    alarm(60);
+    test_socketpair();
+    test_unsealed_memfd();
+    test_stray_fd();
+    test_socket_path();
+    test_budget_deadlock();
+    return TEST_RESULT();
+}
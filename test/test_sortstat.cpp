@@ -0,0 +1,148 @@
+/**
+ * Tests of the sort instrumentation, built with -DWTTOOL_SORT_STATS so the
+ * SORT_STAT_* macros of every sort in sort.hpp are compiled in.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "sort.hpp"
+#include "test.hpp"
+
+#ifndef WTTOOL_SORT_STATS
+#error "test_sortstat must be built with -DWTTOOL_SORT_STATS"
+#endif
+
+using namespace wttool;
+
+/**
+ * The counters of this thread since before.
+ */
+static SortStatsSnapshot since(const SortStatsSnapshot& before) {
+    SortStatsSnapshot now = sort_stats().snapshot();
+    now.comparisons -= before.comparisons;
+    now.moves -= before.moves;
+    now.bytes_allocated -= before.bytes_allocated;
+    now.calls -= before.calls;
+    return now;
+}
+
+static vector<int64_t> random_data(int64_t n, uint32_t seed) {
+    std::mt19937 gen(seed);
+    vector<int64_t> data(n);
+    for (int64_t i = 0; i < n; ++i) {
+        data[i] = gen() % 1000;
+    }
+    return data;
+}
+
+static void test_tsort() {
+    const int64_t n = 5000;
+    vector<int64_t> data(n);
+    for (int64_t i = 0; i < n; ++i) {
+        data[i] = i;
+    }
+    SortStatsSnapshot before = sort_stats().snapshot();
+    tsort(data.data(), n);
+    SortStatsSnapshot stats = since(before);
+    CHECK(stats.comparisons == (uint64_t)n - 1);
+    CHECK(stats.bytes_allocated == 0);
+    CHECK(stats.calls == 1);
+
+    data = random_data(n, 1);
+    before = sort_stats().snapshot();
+    tsort(data.data(), n);
+    stats = since(before);
+    CHECK(std::is_sorted(data.begin(), data.end()));
+    CHECK(stats.comparisons > (uint64_t)n && stats.moves > 0 && stats.bytes_allocated > 0);
+    CHECK(stats.max_depth >= 2 && stats.calls == 1);
+}
+
+/**
+ * Every sort compiles with the macros and counts its work, the recursive
+ * ones count one call per top level call.
+ */
+static void test_other_sorts() {
+    const int64_t n = 300;
+    SortStatsSnapshot before = sort_stats().snapshot();
+    vector<int64_t> data = random_data(n, 2);
+    msort(data.data(), n);
+    SortStatsSnapshot stats = since(before);
+    CHECK(std::is_sorted(data.begin(), data.end()));
+    CHECK(stats.bytes_allocated > 0 && stats.comparisons > 0 && stats.moves > 0);
+    CHECK(stats.calls == 1 && stats.max_depth > 2);
+
+    void (*sorts[])(int64_t*, int64_t) = {
+        [](int64_t* d, int64_t l) { qsort(d, l); },
+        [](int64_t* d, int64_t l) { isort(d, l); },
+        [](int64_t* d, int64_t l) { ssort(d, l); },
+        [](int64_t* d, int64_t l) { sel_sort(d, l); }
+    };
+    for (size_t i = 0; i < sizeof(sorts) / sizeof(sorts[0]); ++i) {
+        data = random_data(n, 3 + i);
+        before = sort_stats().snapshot();
+        sorts[i](data.data(), n);
+        stats = since(before);
+        CHECK(std::is_sorted(data.begin(), data.end()));
+        CHECK(stats.comparisons > 0 && stats.moves > 0 && stats.calls == 1);
+    }
+    string line = print_sort_stats(sort_stats().snapshot());
+    CHECK(line.find("comparisons=") == 0 && line.find("merge_ns=") != string::npos);
+}
+
+/**
+ * A living thread is in the per thread counters, an exited one is still
+ * in the total.
+ */
+static void test_threads() {
+    const int64_t n = 2000;
+    std::mutex mutex;
+    std::condition_variable cond;
+    int step = 0;
+    uint64_t thread_comparisons = 0;
+    std::thread worker([&]() {
+        vector<int64_t> data = random_data(n, 9);
+        tsort(data.data(), n);
+        std::unique_lock<std::mutex> lock(mutex);
+        thread_comparisons = sort_stats().snapshot().comparisons;
+        step = 1;
+        cond.notify_all();
+        cond.wait(lock, [&]() { return step == 2; });
+    });
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&]() { return step == 1; });
+    }
+    CHECK(thread_comparisons > 0);
+    vector<SortStatsSnapshot> per_thread;
+    SortStatsSnapshot total = sort_stats_collect(&per_thread);
+    bool found = false;
+    for (size_t i = 0; i < per_thread.size(); ++i) {
+        found = found || per_thread[i].comparisons == thread_comparisons;
+    }
+    CHECK(found);
+    CHECK(total.comparisons >= sort_stats().snapshot().comparisons + thread_comparisons);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        step = 2;
+    }
+    cond.notify_all();
+    worker.join();
+    SortStatsSnapshot after = sort_stats_collect(&per_thread);
+    CHECK(after.comparisons == total.comparisons);
+    CHECK(per_thread.size() == 1);
+}
+
+int main() {
+    test_tsort();
+    test_other_sorts();
+    test_threads();
+    return TEST_RESULT();
+}
@@ -0,0 +1,142 @@
+/**
+ * Tests of TimeWheel, driven by advance() so the timing is exact.
+ * Author: LiWentan.
+ * First Modified Date: 2026/10/19.
+ */
+
+#include <stdint.h>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "timewheel.hpp"
+#include "test.hpp"
+
+using namespace wttool;
+
+struct Fired {
+    TimeWheel*         wheel;
+    vector<uint64_t>   ids;
+    vector<uint64_t>   times;
+};
+
+static void on_fire(uint64_t id, void* arg) {
+    Fired* fired = (Fired*)arg;
+    fired->ids.push_back(id);
+    fired->times.push_back(fired->wheel->now());
+}
+
+/**
+ * Every timer fires at exactly now + delay, on every level of the wheel.
+ */
+static void test_expiry() {
+    const uint64_t start = 1000003;
+    const uint64_t delays[] = {0, 1, 2, 255, 256, 257, 4095, 16384, 16385, 70000,
+                               (uint64_t)1 << 22, ((uint64_t)1 << 26) + 17, (uint64_t)1 << 33};
+    const size_t count = sizeof(delays) / sizeof(delays[0]);
+    TimeWheel wheel(start);
+    Fired fired;
+    fired.wheel = &wheel;
+    std::map<uint64_t, uint64_t> expect;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t id = wheel.schedule(delays[i], on_fire, &fired);
+        CHECK(id != 0);
+        expect[id] = start + ((delays[i] == 0) ? 1 : delays[i]);
+    }
+    CHECK(wheel.size() == count);
+    CHECK(wheel.advance(((uint64_t)1 << 33) + 1) == (int64_t)count);
+    CHECK(wheel.size() == 0);
+    CHECK(fired.ids.size() == count);
+    for (size_t i = 0; i < fired.ids.size(); ++i) {
+        CHECK(fired.times[i] == expect[fired.ids[i]]);
+    }
+    // Nothing fires one tick early.
+    TimeWheel early(0);
+    Fired early_fired;
+    early_fired.wheel = &early;
+    early.schedule(300, on_fire, &early_fired);
+    CHECK(early.advance_to(299) == 0);
+    CHECK(early.advance_to(300) == 1);
+}
+
+static void test_cancel_reschedule() {
+    TimeWheel wheel(0);
+    Fired fired;
+    fired.wheel = &wheel;
+    uint64_t a = wheel.schedule(100, on_fire, &fired);
+    uint64_t b = wheel.schedule(100, on_fire, &fired);
+    uint64_t c = wheel.schedule(5000, on_fire, &fired);
+    CHECK(wheel.cancel(a) == 0);
+    CHECK(wheel.cancel(a) == -1);
+    CHECK(wheel.reschedule(b, 10) == 0);
+    CHECK(wheel.reschedule(c, 20) == 0);
+    CHECK(wheel.size() == 2);
+    wheel.advance(10);
+    CHECK(fired.ids.size() == 1 && fired.ids[0] == b && fired.times[0] == 10);
+    wheel.advance(10);
+    CHECK(fired.ids.size() == 2 && fired.ids[1] == c && fired.times[1] == 20);
+    CHECK(wheel.cancel(b) == -1);
+    CHECK(wheel.reschedule(c, 1) == -1);
+    // A pooled node reused by a new timer does not answer to the old id.
+    uint64_t d = wheel.schedule(1, on_fire, &fired);
+    CHECK(d != b && d != c);
+    CHECK(wheel.cancel(b) == -1 && wheel.cancel(c) == -1);
+    CHECK(wheel.cancel(d) == 0);
+    CHECK(wheel.advance(10000) == 0);
+    CHECK(fired.ids.size() == 2);
+}
+
+/**
+ * Random schedule, cancel and reschedule against a plain map.
+ */
+static void test_random() {
+    std::mt19937_64 gen(33);
+    TimeWheel wheel(12345);
+    Fired fired;
+    fired.wheel = &wheel;
+    std::map<uint64_t, uint64_t> expect;
+    vector<uint64_t> ids;
+    for (int round = 0; round < 2000; ++round) {
+        for (int i = 0; i < 20; ++i) {
+            uint64_t delay = (gen() % 4 == 0) ? gen() % 1000000 : gen() % 2000;
+            uint64_t id = wheel.schedule(delay, on_fire, &fired);
+            expect[id] = wheel.now() + ((delay == 0) ? 1 : delay);
+            ids.push_back(id);
+        }
+        for (int i = 0; i < 5; ++i) {
+            uint64_t id = ids[gen() % ids.size()];
+            bool armed = expect.count(id) != 0;
+            if (gen() % 2 == 0) {
+                CHECK(wheel.cancel(id) == (armed ? 0 : -1));
+                expect.erase(id);
+            } else {
+                uint64_t delay = gen() % 3000;
+                CHECK(wheel.reschedule(id, delay) == (armed ? 0 : -1));
+                if (armed) {
+                    expect[id] = wheel.now() + ((delay == 0) ? 1 : delay);
+                }
+            }
+        }
+        size_t before = fired.ids.size();
+        wheel.advance(gen() % 500);
+        for (size_t i = before; i < fired.ids.size(); ++i) {
+            CHECK(expect.count(fired.ids[i]) == 1);
+            CHECK(expect[fired.ids[i]] == fired.times[i]);
+            expect.erase(fired.ids[i]);
+        }
+        for (std::map<uint64_t, uint64_t>::iterator it = expect.begin(); it != expect.end(); ++it) {
+            if (it->second <= wheel.now()) {
+                CHECK(false);
+                break;
+            }
+        }
+        CHECK(wheel.size() == expect.size());
+    }
+}
+
+int main() {
+    test_expiry();
+    test_cancel_reschedule();
+    test_random();
+    return TEST_RESULT();
+}